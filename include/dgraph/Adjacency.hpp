@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Types.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace dgraph {
+
+// How Graph stores the neighbor ids of its CSR rows
+enum class AdjacencyEncoding {
+    Plain,        // VertexId (64-bit) per neighbor
+    Compact32,    // uint32_t per neighbor; requires global vertex count < 2^32
+    DeltaVarint   // Sorted rows stored as first id + gaps, LEB128 varint encoded
+};
+
+inline const char* adjacencyEncodingName(AdjacencyEncoding enc) {
+    switch (enc) {
+        case AdjacencyEncoding::Compact32: return "u32";
+        case AdjacencyEncoding::DeltaVarint: return "varint";
+        default: return "plain";
+    }
+}
+
+inline bool parseAdjacencyEncoding(const std::string& name, AdjacencyEncoding& enc) {
+    if (name == "plain") enc = AdjacencyEncoding::Plain;
+    else if (name == "u32") enc = AdjacencyEncoding::Compact32;
+    else if (name == "varint") enc = AdjacencyEncoding::DeltaVarint;
+    else return false;
+    return true;
+}
+
+// Append the LEB128 encoding of value to out. Returns the number of bytes written.
+inline size_t encodeVarint(uint64_t value, uint8_t* out) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+inline size_t varintLength(uint64_t value) {
+    size_t n = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+inline const uint8_t* decodeVarint(const uint8_t* in, uint64_t& value) {
+    uint64_t result = in[0] & 0x7f;
+    if (in[0] < 0x80) {
+        value = result;
+        return in + 1;
+    }
+    int shift = 7;
+    ++in;
+    while (true) {
+        uint8_t byte = *in++;
+        result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) break;
+        shift += 7;
+    }
+    value = result;
+    return in;
+}
+
+// Forward iterator that decodes one neighbor list regardless of encoding
+class NeighborIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = VertexId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const VertexId*;
+    using reference = VertexId;
+
+    NeighborIterator() = default;
+    NeighborIterator(AdjacencyEncoding enc, const uint8_t* pos, const uint8_t* end)
+        : enc_(enc), pos_(pos), end_(end) {
+        if (pos_ != end_) decode(0);
+    }
+
+    VertexId operator*() const { return current_; }
+
+    NeighborIterator& operator++() {
+        pos_ = next_;
+        if (pos_ != end_) decode(current_);
+        return *this;
+    }
+
+    NeighborIterator operator++(int) {
+        NeighborIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    bool operator==(const NeighborIterator& other) const { return pos_ == other.pos_; }
+    bool operator!=(const NeighborIterator& other) const { return pos_ != other.pos_; }
+
+private:
+    void decode(VertexId previous) {
+        switch (enc_) {
+            case AdjacencyEncoding::Plain:
+                std::memcpy(&current_, pos_, sizeof(VertexId));
+                next_ = pos_ + sizeof(VertexId);
+                break;
+            case AdjacencyEncoding::Compact32: {
+                uint32_t v;
+                std::memcpy(&v, pos_, sizeof(uint32_t));
+                current_ = v;
+                next_ = pos_ + sizeof(uint32_t);
+                break;
+            }
+            case AdjacencyEncoding::DeltaVarint: {
+                // The first entry of a row is absolute; previous is 0 at the row start
+                uint64_t gap;
+                next_ = decodeVarint(pos_, gap);
+                current_ = previous + gap;
+                break;
+            }
+        }
+    }
+
+    AdjacencyEncoding enc_ = AdjacencyEncoding::Plain;
+    const uint8_t* pos_ = nullptr;
+    const uint8_t* next_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    VertexId current_ = 0;
+};
+
+// Range over the neighbors of one vertex, usable in range-for
+class NeighborRange {
+public:
+    NeighborRange(AdjacencyEncoding enc, const uint8_t* begin, const uint8_t* end, uint64_t count)
+        : enc_(enc), begin_(begin), end_(end), count_(count) {}
+
+    NeighborIterator begin() const { return NeighborIterator(enc_, begin_, end_); }
+    NeighborIterator end() const { return NeighborIterator(enc_, end_, end_); }
+    uint64_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    AdjacencyEncoding enc_;
+    const uint8_t* begin_;
+    const uint8_t* end_;
+    uint64_t count_;
+};
+
+} // namespace dgraph
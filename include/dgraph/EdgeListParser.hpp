@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Types.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace dgraph {
+
+// Hand-written scanner for the text edge-list format:
+//
+//   <num_vertices>
+//   <src> <dst> [weight]
+//   ...
+//
+// Blank lines and lines starting with '#' or '%' are ignored. Weights may carry an exponent;
+// missing or non-numeric ones (a trailing comment, say) default to 1.0.
+
+// Parse the leading vertex count. Returns the byte offset of the first edge line.
+uint64_t parseEdgeListHeader(const char* data, uint64_t size, VertexId& num_vertices);
+
+// Parse every line whose first byte lies in [begin, end), appending to `edges`.
+// A line straddling `end` is parsed in full, and a partial line at `begin` is
+// skipped, so disjoint ranges covering the file parse each edge exactly once.
+void parseEdgeListRange(const char* data, uint64_t size, uint64_t begin, uint64_t end,
+                        std::vector<Edge>& edges);
+
+} // namespace dgraph
@@ -1,11 +1,17 @@
 #pragma once
 
 #include "Graph.hpp"
+#include "Exchange.hpp"
+#include "Frontier.hpp"
+#include "SpMV.hpp"
 #include <vector>
 #include "MPI_Wrapper.hpp"
 #include <functional>
 #include <cstring>
 #include <algorithm>
+#include <iostream>
+#include <limits>
+#include <type_traits>
 
 namespace dgraph {
 
@@ -16,6 +22,25 @@ struct Message {
     T value;
 };
 
+// Identity element plus an associative, commutative reduce. ReduceFn defaults to a
+// std::function; makeCombiner keeps the concrete callable type so the engine can inline it.
+// Algorithms whose messages combine this way can use Engine::runCombined,
+// which scatter-adds into a dense per-vertex array instead of sorting messages.
+template <typename MsgT, typename AccT = MsgT,
+          typename ReduceFn = std::function<void(AccT&, const MsgT&)>>
+struct Combiner {
+    AccT identity;
+    ReduceFn reduce;
+};
+
+template <typename MsgT, typename AccT, typename ReduceFn>
+Combiner<MsgT, AccT, ReduceFn> makeCombiner(AccT identity, ReduceFn reduce) {
+    return Combiner<MsgT, AccT, ReduceFn>{identity, reduce};
+}
+
+// Every run mode takes its scatter/reduce/apply callbacks as template parameters, so
+// lambdas and functors are inlined into the per-vertex and per-message loops (a
+// std::function still works, at the cost of an indirect call per invocation).
 template <typename MsgT, typename AccT = MsgT>
 class Engine {
 public:
@@ -31,89 +56,27 @@ public:
 
     // Determine owner of a global vertex
     int getOwner(VertexId vid) const {
-        VertexId total = graph_.numGlobalVertices();
-        VertexId remainder = total % size_;
-        VertexId chunk = total / size_;
-        
-        VertexId split_point = remainder * (chunk + 1);
-        if (vid < split_point) {
-            return vid / (chunk + 1);
-        } else {
-            return remainder + (vid - split_point) / chunk;
-        }
+        return graph_.ownerOf(vid);
     }
 
-    // Synchronize messages
+    // Synchronize messages. Outgoing buffers are packed into a send arena laid out by
+    // destination rank and received straight into received_messages. Supersteps larger
+    // than the exchange budget (see setExchangeBudget) run in several rounds through a
+    // bounded staging buffer, so counts never overflow MPI's int arguments. All buffers
+    // keep their capacity across supersteps.
     void syncMessages(const std::vector<std::vector<Message<MsgT>>>& send_buffers,
                       std::vector<Message<MsgT>>& received_messages) {
-        
-        std::vector<int> send_counts(size_);
-        std::vector<int> recv_counts(size_);
-        
-        for (int i = 0; i < size_; ++i) {
-            send_counts[i] = send_buffers[i].size() * sizeof(Message<MsgT>);
-        }
-
-        MPI_Alltoall(send_counts.data(), 1, MPI_INT,
-                     recv_counts.data(), 1, MPI_INT, comm_);
-
-        std::vector<int> sdispls(size_, 0);
-        std::vector<int> rdispls(size_, 0);
-        int total_recv_bytes = 0;
-        
-        std::vector<uint8_t> send_flat;
-        
-        for (int i = 0; i < size_; ++i) {
-            sdispls[i] = send_flat.size();
-            const uint8_t* raw_ptr = reinterpret_cast<const uint8_t*>(send_buffers[i].data());
-            send_flat.insert(send_flat.end(), raw_ptr, raw_ptr + send_counts[i]);
-            
-            rdispls[i] = total_recv_bytes;
-            total_recv_bytes += recv_counts[i];
-        }
-
-        std::vector<uint8_t> recv_flat(total_recv_bytes);
-
-        MPI_Alltoallv(send_flat.data(), send_counts.data(), sdispls.data(), MPI_BYTE,
-                      recv_flat.data(), recv_counts.data(), rdispls.data(), MPI_BYTE, comm_);
-
-        int num_msgs = total_recv_bytes / sizeof(Message<MsgT>);
-        received_messages.resize(num_msgs);
-        if (num_msgs > 0) {
-            std::memcpy(received_messages.data(), recv_flat.data(), total_recv_bytes);
-        }
+        sends_.assignContiguous(send_buffers);
+        exchangeSends(received_messages);
     }
 
     // Run a vertex-centric program
-    void run(int iterations, 
-             std::function<void(VertexId, std::vector<std::vector<Message<MsgT>>>&)> scatter_func,
-             std::function<void(AccT&, const MsgT&)> reduce_func,
-             std::function<void(VertexId, const AccT&)> apply_func) {
+    template <typename ScatterFn, typename ReduceFn, typename ApplyFn>
+    void run(int iterations, ScatterFn&& scatter_func, ReduceFn&& reduce_func, ApplyFn&& apply_func) {
         
         for (int iter = 0; iter < iterations; ++iter) {
-            std::vector<std::vector<Message<MsgT>>> send_buffers(size_);
-            
-            #pragma omp parallel
-            {
-                std::vector<std::vector<Message<MsgT>>> thread_local_buffers(size_);
-                
-                #pragma omp for nowait
-                for (VertexId i = 0; i < graph_.numLocalVertices(); ++i) {
-                     scatter_func(i, thread_local_buffers);
-                }
-                
-                #pragma omp critical
-                {
-                    for(int r=0; r<size_; ++r) {
-                        send_buffers[r].insert(send_buffers[r].end(), 
-                                             thread_local_buffers[r].begin(), 
-                                             thread_local_buffers[r].end());
-                    }
-                }
-            }
-
-            std::vector<Message<MsgT>> received_msgs;
-            syncMessages(send_buffers, received_msgs);
+            std::vector<Message<MsgT>>& received_msgs = received_;
+            scatterAndExchange(scatter_func, received_msgs);
 
             std::sort(received_msgs.begin(), received_msgs.end(), 
                       [](const Message<MsgT>& a, const Message<MsgT>& b) { return a.dst < b.dst; });
@@ -143,13 +106,778 @@ public:
         }
     }
 
+    // Run a vertex-centric program whose messages combine (see Combiner).
+    // Received messages are reduced straight into a dense accumulator indexed by
+    // local vertex. Threads own disjoint destination ranges, so the reduction needs
+    // no atomics; apply_func is then called (concurrently, for distinct vertices)
+    // for every vertex that received at least one message.
+    template <typename ScatterFn, typename CombinerT, typename ApplyFn>
+    void runCombined(int iterations, ScatterFn&& scatter_func, const CombinerT& combiner, ApplyFn&& apply_func) {
+        for (int iter = 0; iter < iterations; ++iter) {
+            combinedSuperstep(scatter_func, combiner, nullptr, [&](VertexId global_dst, const AccT& acc) {
+                apply_func(global_dst, acc);
+            });
+        }
+    }
+
+    // One combined superstep over an active set: scatter_func only runs for vertices in
+    // `active`, and every vertex for which apply_func returns true joins the next
+    // frontier. On return `active` holds that next frontier (already finalized), so
+    // the cost of a superstep is proportional to the active vertices and their messages.
+    template <typename ScatterFn, typename CombinerT, typename ApplyFn>
+    void runFrontier(Frontier& active, ScatterFn&& scatter_func, const CombinerT& combiner, ApplyFn&& apply_func) {
+        const VertexId start_id = graph_.globalStartId();
+        if (next_frontier_.numVertices() != graph_.numLocalVertices()) {
+            next_frontier_.resize(graph_.numLocalVertices());
+        }
+        next_frontier_.clear();
+
+        combinedSuperstep(scatter_func, combiner, &active, [&](VertexId global_dst, const AccT& acc) {
+            if (apply_func(global_dst, acc)) next_frontier_.insert(global_dst - start_id);
+        });
+
+        next_frontier_.finalize();
+        active.swap(next_frontier_);
+    }
+
+    // Run a vertex-centric program that needs all of a vertex's messages at once (a mode,
+    // a median, ...) rather than a running reduction. Received messages are counting-sorted
+    // by destination into buffers reused across supersteps, and apply_func gets each
+    // destination's values as one contiguous run. It runs concurrently for distinct vertices
+    // and is only called for vertices that received at least one message.
+    template <typename ScatterFn, typename ApplyFn>
+    void runGrouped(int iterations, ScatterFn&& scatter_func, ApplyFn&& apply_func) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+
+        for (int iter = 0; iter < iterations; ++iter) {
+            std::vector<Message<MsgT>>& received_msgs = received_;
+            scatterAndExchange(scatter_func, received_msgs);
+            const size_t num_msgs = received_msgs.size();
+
+            group_offsets_.assign(num_local + 1, 0);
+            grouped_values_.resize(num_msgs);
+
+            #pragma omp parallel for
+            for (size_t m = 0; m < num_msgs; ++m) {
+                VertexId local = received_msgs[m].dst - start_id;
+                #pragma omp atomic
+                group_offsets_[local + 1]++;
+            }
+            for (VertexId i = 0; i < num_local; ++i) {
+                group_offsets_[i + 1] += group_offsets_[i];
+            }
+
+            group_cursor_.assign(group_offsets_.begin(), group_offsets_.end() - 1);
+            #pragma omp parallel for
+            for (size_t m = 0; m < num_msgs; ++m) {
+                VertexId local = received_msgs[m].dst - start_id;
+                size_t pos;
+                #pragma omp atomic capture
+                pos = group_cursor_[local]++;
+                grouped_values_[pos] = received_msgs[m].value;
+            }
+
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (VertexId i = 0; i < num_local; ++i) {
+                size_t begin = group_offsets_[i];
+                size_t end = group_offsets_[i + 1];
+                if (begin != end) apply_func(start_id + i, grouped_values_.data() + begin, end - begin);
+            }
+        }
+    }
+
+    // Messages of the last runGrouped superstep, grouped by destination: local vertex i
+    // received lastGroupedValues()[lastGroupOffsets()[i] .. lastGroupOffsets()[i + 1]).
+    // Valid until the next superstep; callers may swap the buffers out.
+    std::vector<size_t>& lastGroupOffsets() { return group_offsets_; }
+    std::vector<MsgT>& lastGroupedValues() { return grouped_values_; }
+
+    // Global number of active vertices (collective)
+    VertexId globalFrontierSize(const Frontier& frontier) const {
+        uint64_t local = frontier.size();
+        uint64_t global = 0;
+        MPI_Allreduce(&local, &global, 1, MPI_UINT64_T, MPI_SUM, comm_);
+        return global;
+    }
+
+    // Run a pull-mode vertex program over the in-edge index (built on demand).
+    // value_func(local_id) is what a vertex exposes to its out-neighbors; every local
+    // vertex with in-edges folds its in-neighbors' values with reduce_func and is then
+    // passed to apply_func (by global id, like push mode). No per-edge messages are
+    // built: only one value per mirrored vertex crosses ranks, and on a single rank
+    // nothing is communicated at all. apply_func runs concurrently for distinct vertices.
+    template <typename ValueFn, typename ReduceFn, typename ApplyFn>
+    void runPull(int iterations, ValueFn&& value_func, ReduceFn&& reduce_func, ApplyFn&& apply_func) {
+        if (!graph_.hasInEdges()) graph_.buildInEdges();
+        const InEdgeIndex& in = graph_.getInEdges();
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+
+        for (int iter = 0; iter < iterations; ++iter) {
+            publishPullValues(in, value_func);
+
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (VertexId i = 0; i < num_local; ++i) {
+                uint64_t begin = in.row_ptr[i];
+                uint64_t end = in.row_ptr[i + 1];
+                if (begin == end) continue;
+
+                AccT accumulator = AccT();
+                for (uint64_t e = begin; e < end; ++e) {
+                    reduce_func(accumulator, pull_values_[in.sources[e]]);
+                }
+                apply_func(start_id + i, accumulator);
+            }
+        }
+    }
+
+    // runPull for sums of float or double values: the in-edge loop is a gather kernel
+    // (see SpMV.hpp; Auto takes whichever this CPU runs fastest on the index) instead of a
+    // per-edge reduce call.
+    // apply_func gets the sum of every local vertex with in-edges, by global id.
+    template <typename ValueFn, typename ApplyFn>
+    void runPullSum(int iterations, ValueFn&& value_func, ApplyFn&& apply_func, SpmvKernel kernel = SpmvKernel::Auto) {
+        static_assert(std::is_same<MsgT, float>::value || std::is_same<MsgT, double>::value,
+                      "runPullSum gathers float or double values");
+        if (!graph_.hasInEdges()) graph_.buildInEdges();
+        const InEdgeIndex& in = graph_.getInEdges();
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const VertexId kRowBlock = 1024;
+        kernel = resolveSpmvKernel(kernel);
+        // The SIMD gathers take signed 32-bit slot indices
+        if (num_local + in.numGhosts() > static_cast<uint64_t>(INT32_MAX)) kernel = SpmvKernel::Scalar;
+        pull_sums_.resize(num_local);
+
+        for (int iter = 0; iter < iterations; ++iter) {
+            publishPullValues(in, value_func);
+
+            // Auto is measured once per engine on the real index, after values are in place
+            if (kernel == SpmvKernel::Auto) {
+                if (auto_kernel_ == SpmvKernel::Auto) {
+                    auto_kernel_ = fastestSpmvKernel(in.row_ptr.data(), in.sources.data(), pull_values_.data(),
+                                                     pull_sums_.data(), num_local);
+                    if (rank_ == 0) std::cout << "Pull kernel auto: measured " << spmvKernelName(auto_kernel_) << " on rank 0" << std::endl;
+                }
+                kernel = auto_kernel_;
+            }
+
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (VertexId begin = 0; begin < num_local; begin += kRowBlock) {
+                gatherSum(kernel, in.row_ptr.data(), in.sources.data(), pull_values_.data(), pull_sums_.data(),
+                          begin, std::min(begin + kRowBlock, num_local));
+            }
+
+            #pragma omp parallel for
+            for (VertexId i = 0; i < num_local; ++i) {
+                if (in.row_ptr[i] != in.row_ptr[i + 1]) apply_func(start_id + i, pull_sums_[i]);
+            }
+        }
+    }
+
+    // Run a gather-apply-scatter program over the 2D edge grid (built on demand, see EdgeGrid).
+    // value_func(local_id) is what a master exposes along its out-edges; it is mirrored to
+    // the master's grid column only. Every rank folds the in-edges it holds into one partial
+    // per vertex of its grid row, the partials are combined at the masters within the row,
+    // and every master with in-edges is passed to apply_func by global id (concurrently for
+    // distinct vertices). Partials are folded with the combiner, so MsgT must equal AccT.
+    template <typename ValueFn, typename CombinerT, typename ApplyFn>
+    void runGrid(int iterations, ValueFn&& value_func, const CombinerT& combiner, ApplyFn&& apply_func) {
+        static_assert(std::is_same<MsgT, AccT>::value, "runGrid folds partial accumulators like messages");
+        if (!graph_.hasEdgeGrid()) graph_.buildEdgeGrid();
+        const EdgeGrid& grid = graph_.getEdgeGrid();
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+
+        grid_local_.resize(num_local);
+        grid_mirrors_.resize(grid.col_offsets.back());
+        grid_partials_.resize(grid.row_size);
+        grid_received_.resize(grid.cols * num_local);
+
+        for (int iter = 0; iter < iterations; ++iter) {
+            // Scatter: masters publish their value to the mirrors in their grid column
+            #pragma omp parallel for
+            for (VertexId i = 0; i < num_local; ++i) {
+                grid_local_[i] = value_func(i);
+            }
+            allgatherKnownCounts(grid.col_comm, grid_local_.data(), num_local, grid_mirrors_.data(), grid.col_counts);
+
+            // Gather: fold the in-edges held here into partials for the grid row
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (VertexId d = 0; d < grid.row_size; ++d) {
+                AccT partial = combiner.identity;
+                for (uint64_t e = grid.dst_ptr[d]; e < grid.dst_ptr[d + 1]; ++e) {
+                    combiner.reduce(partial, grid_mirrors_[grid.sources[e]]);
+                }
+                grid_partials_[d] = partial;
+            }
+            exchangeKnownCounts(grid.row_comm, grid_partials_.data(), grid.row_counts,
+                                grid_received_.data(), grid.row_recv_counts);
+
+            // Apply: masters combine the partials of their grid row
+            #pragma omp parallel for
+            for (VertexId i = 0; i < num_local; ++i) {
+                if (!grid.has_in_edges[i]) continue;
+                AccT accumulator = combiner.identity;
+                for (int c = 0; c < grid.cols; ++c) {
+                    combiner.reduce(accumulator, grid_received_[c * num_local + i]);
+                }
+                apply_func(start_id + i, accumulator);
+            }
+        }
+    }
+
     int getRank() const { return rank_; }
 
+    // Pre-combine outgoing messages per destination vertex in runCombined.
+    // Only takes effect when MsgT == AccT (the combiner folds a message into a message).
+    void setSenderCombining(bool enabled) { sender_combining_ = enabled; }
+
+    // Global outgoing bytes before/after sender combining in the last runCombined superstep
+    uint64_t lastCombineBytesBefore() const { return last_combine_bytes_before_; }
+    uint64_t lastCombineBytesAfter() const { return last_combine_bytes_after_; }
+
+    // Overlap scatter with communication in runCombined/runFrontier. Messages travel in
+    // batches of about batch_messages per destination rank (fill levels are checked every
+    // max(64, P) vertices), sent with MPI_Isend while the master thread reduces batches
+    // that have already arrived. Sender combining does not apply in this mode.
+    void setAsyncExchange(bool enabled, size_t batch_messages = 4096) {
+        async_ = enabled;
+        async_batch_ = std::max<size_t>(1, batch_messages);
+    }
+
 private:
+    template <typename ScatterFn, typename CombinerT, typename ApplyFn>
+    void combinedSuperstep(ScatterFn& scatter_func,
+                           const CombinerT& combiner,
+                           const Frontier* active,
+                           ApplyFn&& apply_func) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        // Accumulators are reset to the identity as they are applied, so they only
+        // need a full initialization the first time.
+        if (dense_acc_.size() != num_local) {
+            dense_acc_.assign(num_local, combiner.identity);
+            touched_.assign(num_local, 0);
+        }
+
+        for (auto& list : touched_lists_) list.clear();
+        if (async_) {
+            asyncScatterReduce(scatter_func, combiner, active);
+        } else {
+            exchangeAndReduce(scatter_func, combiner, active);
+        }
+        ++superstep_;
+
+        // Apply and reset the touched vertices. Walking the touched lists (not the
+        // vertex range) keeps sparse supersteps O(messages).
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t t = 0; t < touched_lists_.size(); ++t) {
+            for (VertexId local : touched_lists_[t]) {
+                apply_func(start_id + local, dense_acc_[local]);
+                dense_acc_[local] = combiner.identity;
+                touched_[local] = 0;
+            }
+        }
+    }
+
+    // Bulk-synchronous half of a combined superstep: scatter everything, exchange, reduce
+    template <typename ScatterFn, typename CombinerT>
+    void exchangeAndReduce(ScatterFn& scatter_func,
+                           const CombinerT& combiner,
+                           const Frontier* active) {
+        scatterLocal(scatter_func, active);
+
+        if constexpr (std::is_same<MsgT, AccT>::value) {
+            if (sender_combining_) {
+                uint64_t bytes[2] = {outgoingBytes(), 0};
+                precombine(combiner);
+                bytes[1] = outgoingBytes();
+
+                uint64_t totals[2] = {0, 0};
+                MPI_Allreduce(bytes, totals, 2, MPI_UINT64_T, MPI_SUM, comm_);
+                last_combine_bytes_before_ = totals[0];
+                last_combine_bytes_after_ = totals[1];
+                if (rank_ == 0) {
+                    double saved = totals[0] ? 100.0 * (totals[0] - totals[1]) / totals[0] : 0.0;
+                    std::cout << "Superstep " << superstep_ << ": sender combining " << totals[0]
+                              << " -> " << totals[1] << " bytes (" << saved << "% saved)" << std::endl;
+                }
+            }
+        }
+
+        // Messages are reduced round by round as they arrive, so a superstep larger than
+        // the exchange budget is never held in full on the receiving side
+        planMessages();
+        runExchange(comm_, plan_, sends_, send_arena_, received_,
+                    [&](const Message<MsgT>* msgs, const std::vector<size_t>& pieces, int) {
+                        size_t num_msgs = 0;
+                        for (size_t count : pieces) num_msgs += count;
+                        reduceReceived(msgs, num_msgs, combiner);
+                    });
+    }
+
+    // Pipelined half of a combined superstep. Worker threads scatter into per-thread,
+    // per-destination batches and queue every batch that fills up. The master thread
+    // (the only one making MPI calls, as MPI_THREAD_FUNNELED requires) scatters too, and
+    // every few vertices it sends queued batches, retires completed sends, and reduces
+    // whatever has arrived. Batches for this rank are reduced without going through MPI.
+    // When a rank is done it tells every peer how many batches to expect. Tags alternate
+    // with the superstep parity, since a rank is never more than one superstep ahead.
+    template <typename ScatterFn, typename CombinerT>
+    void asyncScatterReduce(ScatterFn& scatter_func,
+                            const CombinerT& combiner,
+                            const Frontier* active) {
+        const VertexId start_id = graph_.globalStartId();
+        const int data_tag = (superstep_ & 1) ? 3 : 1;
+        const int done_tag = data_tag + 1;
+        if (touched_lists_.empty()) touched_lists_.resize(1);
+
+        std::vector<AsyncBatch> queued;
+        int threads_done = 0;
+
+        std::vector<AsyncBatch> in_flight;
+        std::vector<MPI_Request> in_flight_requests;
+        std::vector<uint64_t> batches_sent(size_, 0);
+        std::vector<uint64_t> batches_received(size_, 0);
+        std::vector<int64_t> batches_expected(size_, -1);
+
+        // Master only: fold a batch into the dense accumulator
+        auto reduceBatch = [&](const Message<MsgT>* msgs, size_t count) {
+            std::vector<VertexId>& touched_list = touched_lists_[0];
+            for (size_t m = 0; m < count; ++m) {
+                VertexId local = msgs[m].dst - start_id;
+                combiner.reduce(dense_acc_[local], msgs[m].value);
+                if (!touched_[local]) {
+                    touched_[local] = 1;
+                    touched_list.push_back(local);
+                }
+            }
+        };
+
+        // Master only: one round of sends, send completions and receives
+        auto progress = [&]() {
+            std::vector<AsyncBatch> ready;
+            #pragma omp critical(engine_async_queue)
+            ready.swap(queued);
+
+            for (auto& batch : ready) {
+                if (batch.dest == rank_) {
+                    reduceBatch(batch.msgs.data(), batch.msgs.size());
+                    continue;
+                }
+                MPI_Request request;
+                MPI_Isend(batch.msgs.data(), static_cast<int>(batch.msgs.size() * sizeof(Message<MsgT>)), MPI_BYTE,
+                          batch.dest, data_tag, comm_, &request);
+                batches_sent[batch.dest]++;
+                in_flight.push_back(std::move(batch));
+                in_flight_requests.push_back(request);
+            }
+
+            for (size_t k = 0; k < in_flight.size();) {
+                int flag = 0;
+                MPI_Test(&in_flight_requests[k], &flag, MPI_STATUS_IGNORE);
+                if (flag) {
+                    in_flight[k] = std::move(in_flight.back());
+                    in_flight.pop_back();
+                    in_flight_requests[k] = in_flight_requests.back();
+                    in_flight_requests.pop_back();
+                } else {
+                    ++k;
+                }
+            }
+
+            for (;;) {
+                int flag = 0;
+                MPI_Status status;
+                MPI_Iprobe(MPI_ANY_SOURCE, data_tag, comm_, &flag, &status);
+                if (!flag) break;
+                int bytes = 0;
+                MPI_Get_count(&status, MPI_BYTE, &bytes);
+                received_.resize(bytes / sizeof(Message<MsgT>));
+                MPI_Recv(received_.data(), bytes, MPI_BYTE, status.MPI_SOURCE, data_tag, comm_, MPI_STATUS_IGNORE);
+                reduceBatch(received_.data(), received_.size());
+                batches_received[status.MPI_SOURCE]++;
+            }
+
+            for (;;) {
+                int flag = 0;
+                MPI_Status status;
+                MPI_Iprobe(MPI_ANY_SOURCE, done_tag, comm_, &flag, &status);
+                if (!flag) break;
+                uint64_t expected = 0;
+                MPI_Recv(&expected, 1, MPI_UINT64_T, status.MPI_SOURCE, done_tag, comm_, MPI_STATUS_IGNORE);
+                batches_expected[status.MPI_SOURCE] = static_cast<int64_t>(expected);
+            }
+        };
+
+        #pragma omp parallel
+        {
+            const int nthreads = omp_get_num_threads();
+            const bool is_master = omp_get_thread_num() == 0;
+            std::vector<std::vector<Message<MsgT>>> thread_local_buffers(size_);
+            uint64_t visited = 0;
+
+            auto flush = [&](int r) {
+                AsyncBatch batch{r, std::move(thread_local_buffers[r])};
+                thread_local_buffers[r] = std::vector<Message<MsgT>>();
+                thread_local_buffers[r].reserve(async_batch_);
+                #pragma omp critical(engine_async_queue)
+                queued.push_back(std::move(batch));
+            };
+
+            // Buffers are checked every check_interval vertices rather than after each one, which
+            // keeps the O(P) scan at O(1) per vertex; a batch may overshoot async_batch_ by the
+            // messages of that many vertices.
+            const uint64_t check_interval = std::max<uint64_t>(64, size_);
+            auto visit = [&](VertexId i) {
+                scatter_func(i, thread_local_buffers);
+                ++visited;
+                if (visited % check_interval == 0) {
+                    for (int r = 0; r < size_; ++r) {
+                        if (thread_local_buffers[r].size() >= async_batch_) flush(r);
+                    }
+                }
+                if (is_master && (visited & 63) == 0) progress();
+            };
+
+            if (active) {
+                active->forEachParallel(visit);
+            } else {
+                #pragma omp for schedule(dynamic, 256) nowait
+                for (VertexId i = 0; i < graph_.numLocalVertices(); ++i) {
+                    visit(i);
+                }
+            }
+
+            for (int r = 0; r < size_; ++r) {
+                if (!thread_local_buffers[r].empty()) flush(r);
+            }
+            #pragma omp atomic
+            threads_done++;
+
+            if (is_master) {
+                // Keep the pipeline moving until every thread has queued its last batch
+                for (;;) {
+                    int done;
+                    #pragma omp atomic read
+                    done = threads_done;
+                    progress();
+                    if (done == nthreads) break;
+                }
+                progress();
+
+                std::vector<MPI_Request> done_requests;
+                for (int r = 0; r < size_; ++r) {
+                    if (r == rank_) continue;
+                    done_requests.emplace_back();
+                    MPI_Isend(&batches_sent[r], 1, MPI_UINT64_T, r, done_tag, comm_, &done_requests.back());
+                }
+
+                for (;;) {
+                    bool complete = true;
+                    for (int r = 0; r < size_; ++r) {
+                        if (r == rank_) continue;
+                        if (batches_expected[r] < 0 ||
+                            batches_received[r] < static_cast<uint64_t>(batches_expected[r])) {
+                            complete = false;
+                        }
+                    }
+                    if (complete) break;
+                    progress();
+                }
+
+                for (auto& request : in_flight_requests) MPI_Wait(&request, MPI_STATUS_IGNORE);
+                for (auto& request : done_requests) MPI_Wait(&request, MPI_STATUS_IGNORE);
+            }
+        }
+    }
+
+    // Reduce a batch of received messages into dense_acc_. Threads own disjoint
+    // destination ranges, so no atomics are needed; newly touched vertices are
+    // recorded in the owning thread's touched list.
+    template <typename CombinerT>
+    void reduceReceived(const Message<MsgT>* received_msgs, size_t num_msgs,
+                        const CombinerT& combiner) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+
+        #pragma omp parallel
+        {
+            const int tid = omp_get_thread_num();
+            const int nthreads = omp_get_num_threads();
+
+            #pragma omp single
+            {
+                range_counts_.assign(static_cast<size_t>(nthreads) * nthreads, 0);
+                bucketed_.resize(num_msgs);
+                if (touched_lists_.size() < static_cast<size_t>(nthreads)) touched_lists_.resize(nthreads);
+            }
+
+            // Destination range owned by each thread, and the slice of messages it buckets
+            auto range_of = [&](VertexId local) {
+                return static_cast<int>(local * nthreads / num_local);
+            };
+            const size_t chunk_begin = num_msgs * tid / nthreads;
+            const size_t chunk_end = num_msgs * (tid + 1) / nthreads;
+
+            // Counting sort of messages into per-thread destination ranges
+            size_t* my_counts = &range_counts_[static_cast<size_t>(tid) * nthreads];
+            for (size_t m = chunk_begin; m < chunk_end; ++m) {
+                my_counts[range_of(received_msgs[m].dst - start_id)]++;
+            }
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                // Column-major prefix sum: range r's messages from chunk 0, then chunk 1, ...
+                size_t offset = 0;
+                for (int r = 0; r < nthreads; ++r) {
+                    for (int t = 0; t < nthreads; ++t) {
+                        size_t count = range_counts_[static_cast<size_t>(t) * nthreads + r];
+                        range_counts_[static_cast<size_t>(t) * nthreads + r] = offset;
+                        offset += count;
+                    }
+                }
+            }
+
+            for (size_t m = chunk_begin; m < chunk_end; ++m) {
+                int r = range_of(received_msgs[m].dst - start_id);
+                bucketed_[my_counts[r]++] = received_msgs[m];
+            }
+            #pragma omp barrier
+
+            // After the scatter, my_counts[r] of the last chunk marks the end of range r
+            const size_t range_begin = (tid == 0) ? 0 : range_counts_[static_cast<size_t>(nthreads - 1) * nthreads + tid - 1];
+            const size_t range_end = range_counts_[static_cast<size_t>(nthreads - 1) * nthreads + tid];
+
+            std::vector<VertexId>& touched_list = touched_lists_[tid];
+            for (size_t m = range_begin; m < range_end; ++m) {
+                VertexId local = bucketed_[m].dst - start_id;
+                combiner.reduce(dense_acc_[local], bucketed_[m].value);
+                if (!touched_[local]) {
+                    touched_[local] = 1;
+                    touched_list.push_back(local);
+                }
+            }
+        }
+    }
+
+    // Pull mode: evaluate value_func for every local vertex and refresh the ghost copies
+    // of remote in-neighbors
+    template <typename ValueFn>
+    void publishPullValues(const InEdgeIndex& in, ValueFn& value_func) {
+        const VertexId num_local = graph_.numLocalVertices();
+        pull_values_.resize(num_local + in.numGhosts());
+        pull_send_.resize(in.send_local_ids.size());
+
+        #pragma omp parallel for
+        for (VertexId i = 0; i < num_local; ++i) {
+            pull_values_[i] = value_func(i);
+        }
+
+        #pragma omp parallel for
+        for (size_t k = 0; k < in.send_local_ids.size(); ++k) {
+            pull_send_[k] = pull_values_[in.send_local_ids[k]];
+        }
+        exchangeKnownCounts(comm_, pull_send_.data(), in.send_counts,
+                            pull_values_.data() + num_local, in.ghost_counts);
+    }
+
+    // Trade per-rank message counts and split the exchange into rounds if needed
+    void planMessages() {
+        planExchange<Message<MsgT>>(comm_, sends_.totals, plan_);
+        if (plan_.rounds > 1 && rank_ == 0) {
+            std::cout << "Superstep " << superstep_ << ": exchange split into " << plan_.rounds
+                      << " rounds (budget " << exchangeBudgetBytes() / (1024.0 * 1024.0) << " MiB)" << std::endl;
+        }
+    }
+
+    // Exchange the messages described by sends_ and materialize everything received.
+    // Supersteps larger than the exchange budget (see setExchangeBudget) run in several
+    // rounds through a bounded staging buffer, so counts never overflow MPI's int arguments.
+    void exchangeSends(std::vector<Message<MsgT>>& received_messages) {
+        planMessages();
+        if (plan_.rounds == 1) {
+            runExchange(comm_, plan_, sends_, send_arena_, received_messages,
+                        [](const Message<MsgT>*, const std::vector<size_t>&, int) {});
+            return;
+        }
+
+        received_messages.resize(plan_.total_recv);
+        runExchange(comm_, plan_, sends_, send_arena_, recv_stage_,
+                    [&](const Message<MsgT>* stage, const std::vector<size_t>& pieces, int round) {
+                        placeRound(plan_, stage, pieces, round, received_messages.data());
+                    });
+    }
+
+    uint64_t outgoingBytes() const {
+        // Everything handed to the exchange, including the self-addressed messages
+        uint64_t bytes = 0;
+        for (size_t total : sends_.totals) bytes += total * sizeof(Message<MsgT>);
+        return bytes;
+    }
+
+    // Scatter over all local vertices and exchange
+    template <typename ScatterFn>
+    void scatterAndExchange(ScatterFn& scatter_func,
+                            std::vector<Message<MsgT>>& received_msgs) {
+        scatterLocal(scatter_func, nullptr);
+        exchangeSends(received_msgs);
+    }
+
+    // Scatter over all local vertices, or only the active ones if a frontier is given.
+    // Every thread writes to its own per-destination outboxes, which stay separate (no
+    // merge, no critical section) and keep their capacity across supersteps; sends_ then
+    // lists them as segments, with offsets from a prefix sum over threads.
+    template <typename ScatterFn>
+    void scatterLocal(ScatterFn& scatter_func,
+                      const Frontier* active) {
+        int nthreads_used = 1;
+        #pragma omp parallel
+        {
+            #pragma omp single
+            {
+                nthreads_used = omp_get_num_threads();
+                if (thread_outboxes_.size() < static_cast<size_t>(nthreads_used)) {
+                    thread_outboxes_.resize(nthreads_used);
+                }
+                for (auto& outboxes : thread_outboxes_) {
+                    outboxes.resize(size_);
+                    for (auto& box : outboxes) box.clear();
+                }
+            }
+
+            std::vector<std::vector<Message<MsgT>>>& my_outboxes = thread_outboxes_[omp_get_thread_num()];
+            if (active) {
+                active->forEachParallel([&](VertexId i) { scatter_func(i, my_outboxes); });
+            } else {
+                #pragma omp for nowait
+                for (VertexId i = 0; i < graph_.numLocalVertices(); ++i) {
+                     scatter_func(i, my_outboxes);
+                }
+            }
+        }
+
+        describeSends(nthreads_used);
+    }
+
+    // Point sends_ at the thread outboxes: one segment per (destination, thread)
+    void describeSends(int nthreads) {
+        sends_.reset(size_, nthreads);
+        for (int r = 0; r < size_; ++r) {
+            for (int t = 0; t < nthreads; ++t) {
+                const auto& box = thread_outboxes_[t][r];
+                sends_.at(r, t) = {box.data(), box.size(), 0};
+            }
+        }
+        sends_.finalize();
+    }
+
+    // Fold messages with the same dst across all threads' outboxes for each destination
+    // rank (needs MsgT == AccT). Each outbox is compacted in place.
+    template <typename CombinerT>
+    void precombine(const CombinerT& combiner) {
+        const int nthreads = sends_.per_dest;
+
+        #pragma omp parallel
+        {
+            // Open-addressing table from dst to the message that keeps it, reused per destination
+            std::vector<VertexId> keys;
+            std::vector<Message<MsgT>*> kept;
+
+            #pragma omp for schedule(dynamic, 1)
+            for (int r = 0; r < size_; ++r) {
+                const size_t total = sends_.totals[r];
+                if (total < 2) continue;
+
+                size_t capacity = 16;
+                while (capacity < total * 2) capacity <<= 1;
+                const size_t mask = capacity - 1;
+                const VertexId empty = std::numeric_limits<VertexId>::max();
+                keys.assign(capacity, empty);
+                kept.resize(capacity);
+
+                for (int t = 0; t < nthreads; ++t) {
+                    auto& buffer = thread_outboxes_[t][r];
+                    size_t out = 0;
+                    for (size_t m = 0; m < buffer.size(); ++m) {
+                        const VertexId dst = buffer[m].dst;
+                        size_t h = (dst * 0x9E3779B97F4A7C15ULL) >> 17;
+                        while (true) {
+                            h &= mask;
+                            if (keys[h] == empty) {
+                                keys[h] = dst;
+                                buffer[out] = buffer[m];
+                                kept[h] = &buffer[out++];
+                                break;
+                            }
+                            if (keys[h] == dst) {
+                                combiner.reduce(kept[h]->value, buffer[m].value);
+                                break;
+                            }
+                            ++h;
+                        }
+                    }
+                    buffer.resize(out);
+                }
+            }
+        }
+
+        describeSends(nthreads);
+    }
+
     Graph& graph_;
     MPI_Comm comm_;
     int rank_;
     int size_;
+
+    // A batch of messages for one destination rank (async mode)
+    struct AsyncBatch {
+        int dest;
+        std::vector<Message<MsgT>> msgs;
+    };
+
+    Frontier next_frontier_;
+    bool sender_combining_ = false;
+    bool async_ = false;
+    size_t async_batch_ = 4096;
+    uint64_t superstep_ = 0;
+    uint64_t last_combine_bytes_before_ = 0;
+    uint64_t last_combine_bytes_after_ = 0;
+
+    // Message exchange buffers, reused across supersteps
+    std::vector<std::vector<std::vector<Message<MsgT>>>> thread_outboxes_; // [thread][dest]
+    SendSegments<Message<MsgT>> sends_;
+    std::vector<Message<MsgT>> send_arena_;
+    std::vector<Message<MsgT>> received_;
+    std::vector<Message<MsgT>> recv_stage_;
+    ExchangePlan plan_;
+
+    // Combined mode: dense accumulator per local vertex and bucketing scratch
+    std::vector<AccT> dense_acc_;
+    std::vector<uint8_t> touched_;
+    std::vector<Message<MsgT>> bucketed_;
+    std::vector<size_t> range_counts_;
+    std::vector<std::vector<VertexId>> touched_lists_;
+
+    // Grouped mode: per-destination offsets, fill cursors and the grouped values
+    std::vector<size_t> group_offsets_;
+    std::vector<size_t> group_cursor_;
+    std::vector<MsgT> grouped_values_;
+
+    // Pull mode: value per slot (locals then ghosts) and staging for mirrored values
+    std::vector<MsgT> pull_values_;
+    std::vector<MsgT> pull_send_;
+    std::vector<MsgT> pull_sums_;
+    SpmvKernel auto_kernel_ = SpmvKernel::Auto; // What Auto measured to, once known
+
+    // Grid execution (see runGrid)
+    std::vector<MsgT> grid_local_;
+    std::vector<MsgT> grid_mirrors_;
+    std::vector<AccT> grid_partials_;
+    std::vector<AccT> grid_received_;
 };
 
 } // namespace dgraph
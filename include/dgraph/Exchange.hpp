@@ -0,0 +1,337 @@
+#pragma once
+
+#include "MPI_Wrapper.hpp"
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+namespace dgraph {
+
+// Upper bound on the bytes a rank stages for one exchange round (on the send side
+// and on the receive side). Exchanges larger than this, or whose byte counts would
+// not fit MPI's int arguments, are split into several rounds. Atomic because simulated
+// ranks (see mock_mpi.hpp) are threads of one process sharing it.
+inline std::atomic<size_t>& exchangeBudgetStorage() {
+    static std::atomic<size_t> budget{size_t(1) << 30};
+    return budget;
+}
+
+inline size_t exchangeBudgetBytes() { return exchangeBudgetStorage().load(std::memory_order_relaxed); }
+
+inline void setExchangeBudget(size_t bytes) { exchangeBudgetStorage().store(bytes, std::memory_order_relaxed); }
+
+// Record counts of one all-to-all exchange and how it is split into rounds.
+// In round k every peer pair moves the records [k * chunk, (k + 1) * chunk) of its
+// traffic, so each round stages at most size * chunk records per side.
+struct ExchangePlan {
+    std::vector<size_t> send_counts; // Records to each rank
+    std::vector<size_t> recv_counts; // Records from each rank
+    size_t total_send = 0;
+    size_t total_recv = 0;
+    size_t chunk = 0;
+    int rounds = 1;
+};
+
+// Collective: split a plan whose counts are filled in into rounds every rank agrees on
+template <typename T>
+void chooseRounds(MPI_Comm comm, ExchangePlan& plan) {
+    const size_t size = plan.send_counts.size();
+    plan.total_send = 0;
+    plan.total_recv = 0;
+    uint64_t largest = 0;
+    for (size_t i = 0; i < size; ++i) {
+        plan.total_send += plan.send_counts[i];
+        plan.total_recv += plan.recv_counts[i];
+        largest = std::max<uint64_t>(largest, plan.send_counts[i]);
+    }
+
+    // A round's displacements are int byte offsets, so it also has to stay under INT_MAX
+    size_t round_bytes = std::min<size_t>(exchangeBudgetBytes(), std::numeric_limits<int>::max());
+    plan.chunk = std::max<size_t>(1, round_bytes / (size * sizeof(T)));
+
+    uint64_t global_largest = 0;
+    MPI_Allreduce(&largest, &global_largest, 1, MPI_UINT64_T, MPI_MAX, comm);
+    plan.rounds = std::max<int>(1, static_cast<int>((global_largest + plan.chunk - 1) / plan.chunk));
+}
+
+// Collective: trade record counts and agree on the round count
+template <typename T>
+void planExchange(MPI_Comm comm, const std::vector<size_t>& send_record_counts, ExchangePlan& plan) {
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    plan.send_counts = send_record_counts;
+    plan.recv_counts.assign(size, 0);
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "counts travel as MPI_UINT64_T");
+    MPI_Alltoall(plan.send_counts.data(), 1, MPI_UINT64_T,
+                 plan.recv_counts.data(), 1, MPI_UINT64_T, comm);
+    chooseRounds<T>(comm, plan);
+}
+
+// Outgoing records of one rank as a scatter-gather list: every destination's stream is
+// made of per_dest segments (e.g. one per thread) that stay where they were written and
+// are packed straight into the send stage.
+template <typename T>
+struct SendSegments {
+    struct Segment {
+        const T* data;
+        size_t count;
+        size_t offset; // Start within the destination's stream
+    };
+
+    int per_dest = 1;
+    std::vector<Segment> segments; // [dest * per_dest + k]
+    std::vector<size_t> totals;    // Records per destination
+
+    void reset(int num_dests, int segments_per_dest) {
+        per_dest = segments_per_dest;
+        segments.assign(static_cast<size_t>(num_dests) * segments_per_dest, Segment{nullptr, 0, 0});
+        totals.assign(num_dests, 0);
+    }
+
+    Segment& at(int dest, int k) { return segments[static_cast<size_t>(dest) * per_dest + k]; }
+
+    // Prefix-sum segment offsets within every destination, in parallel over destinations
+    void finalize() {
+        const int num_dests = static_cast<int>(totals.size());
+        #pragma omp parallel for schedule(static)
+        for (int dest = 0; dest < num_dests; ++dest) {
+            size_t offset = 0;
+            for (int k = 0; k < per_dest; ++k) {
+                Segment& seg = at(dest, k);
+                seg.offset = offset;
+                offset += seg.count;
+            }
+            totals[dest] = offset;
+        }
+    }
+
+    // One contiguous segment per destination
+    template <typename Buffers>
+    void assignContiguous(const Buffers& buffers) {
+        reset(static_cast<int>(buffers.size()), 1);
+        for (size_t dest = 0; dest < buffers.size(); ++dest) {
+            segments[dest] = Segment{buffers[dest].data(), buffers[dest].size(), 0};
+        }
+        finalize();
+    }
+};
+
+// Run a planned exchange. Each round's slice of every destination's stream is packed
+// from the segments into send_stage, and everything received is put in recv_stage
+// (pieces from rank 0, 1, ... back to back) and handed to round_sink(stage, piece_counts,
+// round); the piece from rank s holds its records starting at round * plan.chunk.
+// Both stages keep their capacity.
+template <typename T, typename Sink>
+void runExchange(MPI_Comm comm, const ExchangePlan& plan, const SendSegments<T>& sends,
+                 std::vector<T>& send_stage, std::vector<T>& recv_stage, Sink&& round_sink) {
+    static_assert(std::is_trivially_copyable<T>::value, "runExchange ships raw bytes");
+    const int size = static_cast<int>(plan.send_counts.size());
+
+    std::vector<int> send_bytes(size), recv_bytes(size), sdispls(size), rdispls(size);
+    std::vector<size_t> piece_counts(size);
+
+    for (int round = 0; round < plan.rounds; ++round) {
+        const size_t first = static_cast<size_t>(round) * plan.chunk;
+        size_t send_total = 0, recv_total = 0;
+        for (int i = 0; i < size; ++i) {
+            size_t s = plan.send_counts[i] > first ? std::min(plan.chunk, plan.send_counts[i] - first) : 0;
+            size_t r = plan.recv_counts[i] > first ? std::min(plan.chunk, plan.recv_counts[i] - first) : 0;
+            send_bytes[i] = static_cast<int>(s * sizeof(T));
+            recv_bytes[i] = static_cast<int>(r * sizeof(T));
+            sdispls[i] = static_cast<int>(send_total * sizeof(T));
+            rdispls[i] = static_cast<int>(recv_total * sizeof(T));
+            piece_counts[i] = r;
+            send_total += s;
+            recv_total += r;
+        }
+
+        // Copy the part of every segment that falls into this round
+        send_stage.resize(send_total);
+        const size_t num_segments = sends.segments.size();
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t idx = 0; idx < num_segments; ++idx) {
+            const int dest = static_cast<int>(idx / sends.per_dest);
+            const auto& seg = sends.segments[idx];
+            const size_t round_end = first + send_bytes[dest] / sizeof(T);
+            const size_t lo = std::max(seg.offset, first);
+            const size_t hi = std::min(seg.offset + seg.count, round_end);
+            if (lo < hi) {
+                std::memcpy(send_stage.data() + sdispls[dest] / sizeof(T) + (lo - first),
+                            seg.data + (lo - seg.offset), (hi - lo) * sizeof(T));
+            }
+        }
+
+        recv_stage.resize(recv_total);
+        MPI_Alltoallv(send_stage.data(), send_bytes.data(), sdispls.data(), MPI_BYTE,
+                      recv_stage.data(), recv_bytes.data(), rdispls.data(), MPI_BYTE, comm);
+
+        round_sink(static_cast<const T*>(recv_stage.data()), static_cast<const std::vector<size_t>&>(piece_counts), round);
+    }
+}
+
+// Copy one round's pieces to their place in a buffer laid out by source rank
+template <typename T>
+void placeRound(const ExchangePlan& plan, const T* stage, const std::vector<size_t>& piece_counts,
+                int round, T* dest) {
+    const size_t first = static_cast<size_t>(round) * plan.chunk;
+    size_t offset = 0;
+    for (size_t i = 0; i < piece_counts.size(); ++i) {
+        if (piece_counts[i] > 0) std::memcpy(dest + first, stage + offset, piece_counts[i] * sizeof(T));
+        offset += piece_counts[i];
+        dest += plan.recv_counts[i];
+    }
+}
+
+// Single-round exchange of buffers grouped by rank: straight from send to recv, no
+// staging. Only valid when the plan fits in one round, i.e. every offset fits in an int.
+template <typename T>
+void alltoallDirect(MPI_Comm comm, const T* send, const std::vector<size_t>& send_record_counts,
+                    T* recv, const std::vector<size_t>& recv_record_counts) {
+    const int size = static_cast<int>(send_record_counts.size());
+    std::vector<int> send_counts(size), recv_counts(size);
+    std::vector<int> sdispls(size), rdispls(size);
+    int soff = 0, roff = 0;
+    for (int i = 0; i < size; ++i) {
+        send_counts[i] = send_record_counts[i] * sizeof(T);
+        recv_counts[i] = recv_record_counts[i] * sizeof(T);
+        sdispls[i] = soff;
+        rdispls[i] = roff;
+        soff += send_counts[i];
+        roff += recv_counts[i];
+    }
+    MPI_Alltoallv(reinterpret_cast<const uint8_t*>(send), send_counts.data(), sdispls.data(), MPI_BYTE,
+                  reinterpret_cast<uint8_t*>(recv), recv_counts.data(), rdispls.data(), MPI_BYTE, comm);
+}
+
+// All-to-all exchange of trivially copyable records.
+// outboxes[r] holds the records destined for rank r; everything received is
+// appended to `received` in rank order. If recv_counts is given it receives
+// the number of records that came from each rank.
+template <typename T>
+void exchangeBuffers(MPI_Comm comm, const std::vector<std::vector<T>>& outboxes, std::vector<T>& received,
+                     std::vector<size_t>* recv_record_counts = nullptr) {
+    static_assert(std::is_trivially_copyable<T>::value, "exchangeBuffers ships raw bytes");
+
+    SendSegments<T> sends;
+    sends.assignContiguous(outboxes);
+
+    ExchangePlan plan;
+    planExchange<T>(comm, sends.totals, plan);
+    if (recv_record_counts) *recv_record_counts = plan.recv_counts;
+
+    size_t old_size = received.size();
+    received.resize(old_size + plan.total_recv);
+
+    if (plan.rounds == 1) {
+        // Pack the outboxes back to back and receive in place after the existing records
+        std::vector<T> send(plan.total_send);
+        std::vector<size_t> offsets(outboxes.size() + 1, 0);
+        for (size_t r = 0; r < outboxes.size(); ++r) offsets[r + 1] = offsets[r] + outboxes[r].size();
+        const int num_dests = static_cast<int>(outboxes.size());
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int r = 0; r < num_dests; ++r) {
+            if (!outboxes[r].empty()) {
+                std::memcpy(send.data() + offsets[r], outboxes[r].data(), outboxes[r].size() * sizeof(T));
+            }
+        }
+        alltoallDirect(comm, send.data(), plan.send_counts, received.data() + old_size, plan.recv_counts);
+        return;
+    }
+
+    std::vector<T> send_stage, recv_stage;
+    runExchange(comm, plan, sends, send_stage, recv_stage,
+                [&](const T* stage, const std::vector<size_t>& pieces, int round) {
+                    placeRound(plan, stage, pieces, round, received.data() + old_size);
+                });
+}
+
+// All-to-all exchange where both sides already know the record counts
+// (e.g. a fixed mirror/ghost pattern). send and recv are grouped by rank.
+template <typename T>
+void exchangeKnownCounts(MPI_Comm comm, const T* send, const std::vector<size_t>& send_record_counts,
+                         T* recv, const std::vector<size_t>& recv_record_counts) {
+    static_assert(std::is_trivially_copyable<T>::value, "exchangeKnownCounts ships raw bytes");
+
+    const int size = static_cast<int>(send_record_counts.size());
+    ExchangePlan plan;
+    plan.send_counts = send_record_counts;
+    plan.recv_counts = recv_record_counts;
+    chooseRounds<T>(comm, plan);
+
+    if (plan.rounds == 1) {
+        alltoallDirect(comm, send, send_record_counts, recv, recv_record_counts);
+        return;
+    }
+
+    SendSegments<T> sends;
+    sends.reset(size, 1);
+    for (int i = 0; i < size; ++i) {
+        sends.at(i, 0) = {send, send_record_counts[i], 0};
+        send += send_record_counts[i];
+    }
+    sends.finalize();
+
+    std::vector<T> send_stage, recv_stage;
+    runExchange(comm, plan, sends, send_stage, recv_stage,
+                [&](const T* stage, const std::vector<size_t>& pieces, int round) {
+                    placeRound(plan, stage, pieces, round, recv);
+                });
+}
+
+// Allgather where every rank already knows how many records each rank contributes
+// (e.g. mirrors of a fixed vertex set). recv is laid out by rank. Large gathers run in
+// several rounds, each moving at most the exchange budget through a staging buffer.
+template <typename T>
+void allgatherKnownCounts(MPI_Comm comm, const T* send, size_t send_record_count,
+                          T* recv, const std::vector<size_t>& recv_record_counts) {
+    static_assert(std::is_trivially_copyable<T>::value, "allgatherKnownCounts ships raw bytes");
+
+    const int size = static_cast<int>(recv_record_counts.size());
+    size_t largest = 0;
+    for (size_t c : recv_record_counts) largest = std::max(largest, c);
+
+    // Every rank computes the same per-rank step, so all agree on the number of rounds
+    size_t round_bytes = std::min<size_t>(exchangeBudgetBytes(), std::numeric_limits<int>::max());
+    size_t step = std::max<size_t>(1, round_bytes / (sizeof(T) * size));
+
+    std::vector<int> counts(size), displs(size);
+    if (largest <= step) {
+        int offset = 0;
+        for (int i = 0; i < size; ++i) {
+            counts[i] = static_cast<int>(recv_record_counts[i] * sizeof(T));
+            displs[i] = offset;
+            offset += counts[i];
+        }
+        MPI_Allgatherv(reinterpret_cast<const uint8_t*>(send), static_cast<int>(send_record_count * sizeof(T)), MPI_BYTE,
+                       reinterpret_cast<uint8_t*>(recv), counts.data(), displs.data(), MPI_BYTE, comm);
+        return;
+    }
+
+    std::vector<T> stage;
+    for (size_t first = 0; first < largest; first += step) {
+        int offset = 0;
+        for (int i = 0; i < size; ++i) {
+            size_t n = recv_record_counts[i] > first ? std::min(step, recv_record_counts[i] - first) : 0;
+            counts[i] = static_cast<int>(n * sizeof(T));
+            displs[i] = offset;
+            offset += counts[i];
+        }
+        size_t mine = send_record_count > first ? std::min(step, send_record_count - first) : 0;
+        stage.resize(offset / sizeof(T));
+        MPI_Allgatherv(reinterpret_cast<const uint8_t*>(send + (mine > 0 ? first : 0)), static_cast<int>(mine * sizeof(T)), MPI_BYTE,
+                       reinterpret_cast<uint8_t*>(stage.data()), counts.data(), displs.data(), MPI_BYTE, comm);
+
+        T* dest = recv;
+        for (int i = 0; i < size; ++i) {
+            if (counts[i] > 0) std::memcpy(dest + first, stage.data() + displs[i] / sizeof(T), counts[i]);
+            dest += recv_record_counts[i];
+        }
+    }
+}
+
+} // namespace dgraph
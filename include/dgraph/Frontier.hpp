@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Types.hpp"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace dgraph {
+
+// Set of active local vertices for one superstep.
+// Insertions always go into a bitmap (thread-safe, deduplicated). finalize() then
+// picks the representation used for iteration: a sorted sparse list while the
+// frontier is small, or the bitmap itself once it covers more than 1/dense_divisor
+// of the vertices.
+class Frontier {
+public:
+    explicit Frontier(VertexId num_vertices = 0) { resize(num_vertices); }
+
+    void resize(VertexId num_vertices) {
+        num_vertices_ = num_vertices;
+        bits_.assign((num_vertices + 63) / 64, 0);
+        list_.clear();
+        count_ = 0;
+        dense_ = false;
+    }
+
+    // Clears in O(|frontier|) when sparse, O(|V| / 64) when dense
+    void clear() {
+        if (dense_) {
+            std::fill(bits_.begin(), bits_.end(), 0);
+        } else {
+            for (VertexId v : list_) bits_[v >> 6] = 0;
+        }
+        list_.clear();
+        count_ = 0;
+        dense_ = false;
+    }
+
+    // Activate every vertex
+    void fill() {
+        std::fill(bits_.begin(), bits_.end(), ~0ULL);
+        if (num_vertices_ % 64 != 0) bits_.back() = (1ULL << (num_vertices_ % 64)) - 1;
+        list_.clear();
+        count_ = num_vertices_;
+        dense_ = true;
+    }
+
+    // Thread-safe. Returns true if v was not active yet.
+    bool insert(VertexId v) {
+        const uint64_t mask = 1ULL << (v & 63);
+        uint64_t& word = bits_[v >> 6];
+        uint64_t old;
+        #pragma omp atomic capture
+        { old = word; word |= mask; }
+        if (old & mask) return false;
+        #pragma omp atomic
+        count_++;
+        return true;
+    }
+
+    bool contains(VertexId v) const {
+        return (bits_[v >> 6] >> (v & 63)) & 1ULL;
+    }
+
+    // Call once all insertions for the superstep are done
+    void finalize() {
+        dense_ = count_ * dense_divisor_ > num_vertices_;
+        list_.clear();
+        if (dense_) return;
+
+        list_.reserve(count_);
+        for (size_t w = 0; w < bits_.size(); ++w) {
+            uint64_t word = bits_[w];
+            while (word) {
+                int bit = __builtin_ctzll(word);
+                list_.push_back(static_cast<VertexId>(w * 64 + bit));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Visit every active vertex serially (after finalize)
+    template <typename Func>
+    void forEach(Func&& func) const {
+        if (dense_) {
+            for (size_t w = 0; w < bits_.size(); ++w) {
+                uint64_t word = bits_[w];
+                while (word) {
+                    func(static_cast<VertexId>(w * 64 + __builtin_ctzll(word)));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (VertexId v : list_) func(v);
+        }
+    }
+
+    // Visit every active vertex (after finalize); safe to call from inside an omp parallel region
+    template <typename Func>
+    void forEachParallel(Func&& func) const {
+        if (dense_) {
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (size_t w = 0; w < bits_.size(); ++w) {
+                uint64_t word = bits_[w];
+                while (word) {
+                    int bit = __builtin_ctzll(word);
+                    func(static_cast<VertexId>(w * 64 + bit));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            #pragma omp for schedule(dynamic, 256) nowait
+            for (size_t k = 0; k < list_.size(); ++k) {
+                func(list_[k]);
+            }
+        }
+    }
+
+    void swap(Frontier& other) {
+        std::swap(num_vertices_, other.num_vertices_);
+        bits_.swap(other.bits_);
+        list_.swap(other.list_);
+        std::swap(count_, other.count_);
+        std::swap(dense_, other.dense_);
+        std::swap(dense_divisor_, other.dense_divisor_);
+    }
+
+    VertexId size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    bool isDense() const { return dense_; }
+    VertexId numVertices() const { return num_vertices_; }
+    const std::vector<uint64_t>& bitmap() const { return bits_; }
+    const std::vector<VertexId>& list() const { return list_; }
+
+    // Switch to the bitmap once more than num_vertices / divisor are active
+    void setDenseDivisor(VertexId divisor) { dense_divisor_ = divisor; }
+
+private:
+    VertexId num_vertices_ = 0;
+    std::vector<uint64_t> bits_;
+    std::vector<VertexId> list_;
+    VertexId count_ = 0;
+    bool dense_ = false;
+    VertexId dense_divisor_ = 20;
+};
+
+} // namespace dgraph
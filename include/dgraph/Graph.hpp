@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Types.hpp"
+#include "MappedFile.hpp"
+#include "Adjacency.hpp"
+#include "Partition.hpp"
+#include "Ordering.hpp"
 #include <vector>
 #include <string>
 #include "MPI_Wrapper.hpp"
@@ -10,19 +14,76 @@
 #else
 inline int omp_get_thread_num() { return 0; }
 inline int omp_get_num_threads() { return 1; }
+inline int omp_get_max_threads() { return 1; }
 #endif
 
 namespace dgraph {
 
+// Transposed (CSC) view of the edges pointing at local vertices, used by pull-mode execution.
+// In-neighbors are addressed by "slot": slots [0, numLocalVertices) are local vertices,
+// slots >= numLocalVertices are ghosts, i.e. read-only mirrors of remote vertices.
+struct InEdgeIndex {
+    std::vector<uint64_t> row_ptr;        // numLocalVertices + 1 entries
+    std::vector<uint32_t> sources;        // Slot of each in-neighbor, sorted per row
+    std::vector<VertexId> ghost_ids;      // Global id of each ghost slot, grouped by owner rank
+    std::vector<size_t> ghost_counts;     // Ghosts owned by each rank (what we receive)
+    std::vector<VertexId> send_local_ids; // Local vertices mirrored elsewhere, grouped by requesting rank
+    std::vector<size_t> send_counts;      // Mirrors requested by each rank (what we send)
+
+    VertexId numGhosts() const { return ghost_ids.size(); }
+};
+
+// 2D (vertex-cut) placement of the edges used by grid execution. Ranks form a rows x cols
+// grid, rank = row * cols + col, and every vertex keeps its 1D owner as master. The edge
+// u -> v is stored on the rank in the grid row of owner(v) and the grid column of owner(u),
+// so u's value is only mirrored within its grid column and partial results for v are only
+// combined within its grid row: no step of a superstep involves all ranks.
+struct EdgeGrid {
+    int rows = 0;
+    int cols = 0;
+    int row = 0;                          // This rank's grid coordinates
+    int col = 0;
+    MPI_Comm row_comm = MPI_COMM_NULL;    // Ranks of this grid row, ordered by column
+    MPI_Comm col_comm = MPI_COMM_NULL;    // Ranks of this grid column, ordered by row
+
+    // Column mirrors: values of every vertex mastered in this grid column, by grid row
+    std::vector<size_t> col_counts;       // Masters of each rank in the column
+    std::vector<size_t> col_offsets;      // Where they start in the mirror array (rows + 1 entries)
+
+    // Row partials: one slot per vertex mastered in this grid row (a contiguous id range)
+    VertexId row_start = 0;
+    VertexId row_size = 0;
+    std::vector<size_t> row_counts;       // Masters of each rank in the row (partials sent)
+    std::vector<size_t> row_recv_counts;  // numLocalVertices from every rank in the row
+
+    // Edges held here, CSC by row-partial slot; sources index the mirror array
+    std::vector<uint64_t> dst_ptr;        // row_size + 1 entries
+    std::vector<uint32_t> sources;
+    std::vector<uint8_t> has_in_edges;    // Per local master: has in-edges anywhere in the row
+
+    uint64_t numEdges() const { return sources.size(); }
+};
+
 class Graph {
 public:
     Graph(MPI_Comm comm);
     ~Graph();
 
-    // Load graph from an edge list file (simplified for now: every rank reads and filters)
-    // In production, parallel I/O should be used.
+    // Load graph from an edge list file.
+    // Each rank (and thread) parses a disjoint byte range; edges are then shuffled to their owners.
+    // Binary CSR snapshots (see Snapshot.hpp) are detected by their magic and mapped instead.
     void loadFromFile(const std::string& filename);
 
+    // Write this rank's CSR slice into a binary snapshot (collective).
+    void saveSnapshot(const std::string& filename) const;
+
+    // Map this rank's slice of a binary snapshot as read-only views (collective).
+    // The snapshot must have been written with the same number of ranks.
+    void loadSnapshot(const std::string& filename);
+
+    static bool isSnapshot(const std::string& filename);
+    bool isMapped() const { return snapshot_.isOpen(); }
+
     // Getters
     VertexId numLocalVertices() const { return local_num_vertices_; }
     VertexId numGlobalVertices() const { return global_num_vertices_; }
@@ -31,24 +92,100 @@ public:
     VertexId globalStartId() const { return start_vertex_id_; }
     VertexId globalEndId() const { return end_vertex_id_; } // Exclusive
 
+    // Rank owning a global vertex
+    int ownerOf(VertexId vid) const { return partition_.ownerOf(vid); }
+
+    // Move vertices to ranks according to `strategy` (collective). Hash and LDG relabel
+    // vertices; originalId() and the helpers below translate back to the input's ids.
+    // Must run before compressAdjacency() and buildInEdges().
+    void repartition(PartitionStrategy strategy);
+    const Partition& partition() const { return partition_; }
+    PartitionStrategy partitionStrategy() const { return strategy_; }
+
+    // Renumber the vertices inside every rank's range for cache locality (collective).
+    // Ownership is unchanged; like repartition() it must run before compressAdjacency().
+    void reorder(VertexOrdering ordering);
+    VertexOrdering vertexOrdering() const { return ordering_; }
+    // Mean id distance between consecutive neighbors of a row, a cache-miss proxy (collective)
+    double averageNeighborGap() const;
+
+    // Whether global ids differ from the ids in the input file
+    bool isRelabeled() const { return !original_ids_.empty(); }
+    // Input-file id of a local vertex
+    VertexId originalId(VertexId local_id) const {
+        return original_ids_.empty() ? start_vertex_id_ + local_id : original_ids_[local_id];
+    }
+    // Global id of an input-file id (collective)
+    VertexId internalId(VertexId original) const;
+    // Rewrite input-file ids into global ids in place (collective; every rank passes the same
+    // list). Ids that name no vertex become numGlobalVertices().
+    void toInternalIds(std::vector<VertexId>& ids) const;
+    // Rewrite global ids (e.g. component labels) into input-file ids in place (collective)
+    void toOriginalIds(std::vector<VertexId>& ids) const;
+
+    // Print per-rank vertex, edge and cut-edge imbalance (collective)
+    void printPartitionStats() const;
+
     // CSR Access
-    const std::vector<uint64_t>& getRowPtr() const { return row_ptr_; }
-    const std::vector<VertexId>& getColInd() const { return col_ind_; }
-    const std::vector<EdgeWeight>& getWeights() const { return weights_; }
+    ArrayView<uint64_t> getRowPtr() const { return row_ptr_; }
+    ArrayView<VertexId> getColInd() const { return col_ind_; }
+    ArrayView<EdgeWeight> getWeights() const { return weights_; }
     
     // Out-degree of a local vertex (by local index 0 to numLocalVertices-1)
     VertexId getOutDegree(VertexId local_id) const {
         return row_ptr_[local_id + 1] - row_ptr_[local_id];
     }
     
-    // Get neighbors of a local vertex
-    // Returns pair of start pointer and end pointer in col_ind
-    std::pair<const VertexId*, const VertexId*> getNeighbors(VertexId local_id) const {
+    // 1 / out-degree of every local vertex (0 for vertices without out-edges), computed
+    // whenever the CSR is (re)built so rank-style kernels multiply instead of divide
+    const std::vector<double>& inverseOutDegrees() const { return inv_out_degree_; }
+
+    // Decoding range over the (global) neighbor ids of a local vertex, valid for every encoding
+    NeighborRange neighbors(VertexId local_id) const {
         uint64_t start = row_ptr_[local_id];
         uint64_t end = row_ptr_[local_id + 1];
-        return {&col_ind_[start], &col_ind_[end]};
+        switch (encoding_) {
+            case AdjacencyEncoding::Compact32: {
+                const uint8_t* base = reinterpret_cast<const uint8_t*>(col_ind32_.data());
+                return NeighborRange(encoding_, base + start * sizeof(uint32_t), base + end * sizeof(uint32_t), end - start);
+            }
+            case AdjacencyEncoding::DeltaVarint:
+                return NeighborRange(encoding_, packed_adj_.data() + packed_offsets_[local_id],
+                                     packed_adj_.data() + packed_offsets_[local_id + 1], end - start);
+            default: {
+                const uint8_t* base = reinterpret_cast<const uint8_t*>(col_ind_.data());
+                return NeighborRange(encoding_, base + start * sizeof(VertexId), base + end * sizeof(VertexId), end - start);
+            }
+        }
+    }
+
+    // k-th neighbor of a local vertex (O(1) for plain/u32, O(degree) for varint)
+    VertexId neighborAt(VertexId local_id, uint64_t k) const;
+
+    // Whether local_id has an out-edge to dst. Rows are sorted, so this is a binary search
+    // for plain/u32 and a scan that stops past dst for varint.
+    bool hasEdge(VertexId local_id, VertexId dst) const;
+
+    // Build the in-edge (CSC) index and ghost exchange lists (collective)
+    void buildInEdges();
+    bool hasInEdges() const { return !in_edges_.row_ptr.empty(); }
+    const InEdgeIndex& getInEdges() const { return in_edges_; }
+
+    VertexId getInDegree(VertexId local_id) const {
+        return in_edges_.row_ptr[local_id + 1] - in_edges_.row_ptr[local_id];
     }
 
+    // Build the 2D edge grid and its row/column communicators (collective)
+    void buildEdgeGrid();
+    bool hasEdgeGrid() const { return edge_grid_.rows > 0; }
+    const EdgeGrid& getEdgeGrid() const { return edge_grid_; }
+
+    // Re-encode the neighbor lists; the plain 64-bit ids are released afterwards
+    void compressAdjacency(AdjacencyEncoding encoding);
+    AdjacencyEncoding adjacencyEncoding() const { return encoding_; }
+    // Bytes used by the neighbor ids of this rank (excluding row_ptr and weights)
+    uint64_t adjacencyBytes() const;
+
     int getRank() const { return rank_; }
     int getSize() const { return size_; }
 
@@ -64,13 +201,53 @@ private:
     VertexId start_vertex_id_ = 0;
     VertexId end_vertex_id_ = 0;
 
-    // CSR storage for local vertices' outgoing edges
+    Partition partition_;
+    PartitionStrategy strategy_ = PartitionStrategy::Range;
+    VertexOrdering ordering_ = VertexOrdering::Original;
+    // Input-file id of every local vertex; empty unless the partitioner relabeled vertices
+    std::vector<VertexId> original_ids_;
+
+    // CSR views for local vertices' outgoing edges
     // row_ptr has size local_num_vertices_ + 1
-    std::vector<uint64_t> row_ptr_;
-    std::vector<VertexId> col_ind_;
-    std::vector<EdgeWeight> weights_;
+    // They point either into the owned storage below or into snapshot_.
+    ArrayView<uint64_t> row_ptr_;
+    ArrayView<VertexId> col_ind_;
+    ArrayView<EdgeWeight> weights_;
+
+    // Owned CSR storage (empty when the graph is mapped from a snapshot)
+    std::vector<uint64_t> row_ptr_storage_;
+    std::vector<VertexId> col_ind_storage_;
+    std::vector<EdgeWeight> weights_storage_;
+
+    MappedFile snapshot_;
+
+    std::vector<double> inv_out_degree_;
+
+    // Compressed neighbor storage (see compressAdjacency)
+    AdjacencyEncoding encoding_ = AdjacencyEncoding::Plain;
+    std::vector<uint32_t> col_ind32_;
+    std::vector<uint8_t> packed_adj_;
+    std::vector<uint64_t> packed_offsets_;  // Byte offset of each row in packed_adj_
+
+    InEdgeIndex in_edges_;
+    EdgeGrid edge_grid_;
 
     void distributeVertices(VertexId total_vertices);
+    // Ship every row to its owner under `target`, renaming vertices with relabel(old id) (collective)
+    template <typename RelabelFn>
+    void redistribute(const Partition& target, RelabelFn relabel, bool relabels);
+    std::vector<VertexId> edgeBalancedBoundaries() const;
+    std::vector<int32_t> streamingLDG() const;
+    // answer(local_id) from the owner of every id in `wanted` (sorted, duplicate-free), in order (collective)
+    template <typename AnswerFn>
+    std::vector<VertexId> askOwners(const std::vector<VertexId>& wanted, AnswerFn answer) const;
+    // Build the owned CSR arrays from edges whose sources are all local. Consumes `edges`.
+    void buildCSR(std::vector<Edge>& edges);
+    // Same, from edges split across several buffers. Consumes `parts`.
+    void buildCSR(std::vector<std::vector<Edge>>& parts);
+    void computeInverseDegrees();
+    void bindStorage();
+    void releaseEdgeGrid();
 };
 
 } // namespace dgraph
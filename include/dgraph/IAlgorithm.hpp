@@ -22,6 +22,25 @@ public:
     virtual void run(Graph& graph, const std::vector<std::string>& args) = 0;
 };
 
+// Helpers for plugin arguments: "--key=value" options may be mixed with positional ones.
+inline std::string getOption(const std::vector<std::string>& args, const std::string& key,
+                             const std::string& fallback = "") {
+    const std::string prefix = "--" + key + "=";
+    for (const auto& arg : args) {
+        if (arg.rfind(prefix, 0) == 0) return arg.substr(prefix.size());
+        if (arg == "--" + key) return "true";
+    }
+    return fallback;
+}
+
+inline std::vector<std::string> positionalArgs(const std::vector<std::string>& args) {
+    std::vector<std::string> positional;
+    for (const auto& arg : args) {
+        if (arg.rfind("--", 0) != 0) positional.push_back(arg);
+    }
+    return positional;
+}
+
 // Factory for registering and creating algorithms
 class AlgorithmRegistry {
 public:
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dgraph {
+
+// Read-only memory mapping of (a region of) a file.
+// Pages are mapped MAP_SHARED, so ranks on the same node that map the same
+// snapshot share one copy in the page cache.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map [offset, offset + length) of the file. length == 0 maps to end of file.
+    // offset does not need to be page aligned; the view is adjusted internally.
+    void open(const std::string& filename, uint64_t offset = 0, uint64_t length = 0);
+    void close();
+
+    bool isOpen() const { return base_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    uint64_t size() const { return size_; }
+
+    // Size of the whole file (not just the mapped region)
+    static uint64_t fileSize(const std::string& filename);
+
+private:
+    void* base_ = nullptr;      // Page-aligned address returned by mmap
+    size_t mapped_len_ = 0;     // Length passed to mmap
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+};
+
+} // namespace dgraph
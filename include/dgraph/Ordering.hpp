@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Types.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dgraph {
+
+// Order of the vertices inside every rank's id range (see Graph::reorder)
+enum class VertexOrdering {
+    Original, // Input-file id order
+    Degree,   // Highest out-degree first, so hubs share cache lines
+    RCM,      // Reverse Cuthill-McKee: BFS levels from a low-degree vertex, reversed
+    Gorder    // Greedy windowed placement of vertices that share neighbors (Gorder-like)
+};
+
+inline const char* vertexOrderingName(VertexOrdering ordering) {
+    switch (ordering) {
+        case VertexOrdering::Degree: return "degree";
+        case VertexOrdering::RCM: return "rcm";
+        case VertexOrdering::Gorder: return "gorder";
+        default: return "original";
+    }
+}
+
+inline bool parseVertexOrdering(const std::string& name, VertexOrdering& ordering) {
+    if (name == "original") ordering = VertexOrdering::Original;
+    else if (name == "degree") ordering = VertexOrdering::Degree;
+    else if (name == "rcm") ordering = VertexOrdering::RCM;
+    else if (name == "gorder") ordering = VertexOrdering::Gorder;
+    else return false;
+    return true;
+}
+
+// Undirected view of the edges between the vertices of one rank, by local index.
+// Reordering never moves vertices between ranks, so edges leaving the rank don't
+// constrain the order.
+struct LocalAdjacency {
+    std::vector<uint64_t> row_ptr;     // numVertices + 1 entries
+    std::vector<VertexId> neighbors;   // Sorted, duplicate-free per row
+    std::vector<VertexId> out_degree;  // Full out-degree, including edges leaving the rank
+
+    VertexId numVertices() const { return row_ptr.empty() ? 0 : row_ptr.size() - 1; }
+    VertexId degree(VertexId v) const { return row_ptr[v + 1] - row_ptr[v]; }
+};
+
+// New local index of every local vertex under `ordering`.
+// keys[v] (the input-file ids) defines the Original order and breaks ties in the others.
+std::vector<VertexId> computeOrdering(VertexOrdering ordering, const LocalAdjacency& adj,
+                                      const std::vector<VertexId>& keys);
+
+} // namespace dgraph
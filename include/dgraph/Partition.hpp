@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace dgraph {
+
+// How vertices are assigned to ranks (see Graph::repartition)
+enum class PartitionStrategy {
+    Range,        // Equal-sized contiguous id ranges (the load-time default)
+    EdgeBalanced, // Contiguous id ranges holding roughly equal degree + 1 totals
+    Hash,         // Owner = id mod P; vertices are relabeled so every rank owns a contiguous range
+    LDG           // Streaming Linear Deterministic Greedy placement, then relabeled like Hash
+};
+
+inline const char* partitionStrategyName(PartitionStrategy strategy) {
+    switch (strategy) {
+        case PartitionStrategy::EdgeBalanced: return "edges";
+        case PartitionStrategy::Hash: return "hash";
+        case PartitionStrategy::LDG: return "ldg";
+        default: return "range";
+    }
+}
+
+inline bool parsePartitionStrategy(const std::string& name, PartitionStrategy& strategy) {
+    if (name == "range") strategy = PartitionStrategy::Range;
+    else if (name == "edges") strategy = PartitionStrategy::EdgeBalanced;
+    else if (name == "hash") strategy = PartitionStrategy::Hash;
+    else if (name == "ldg") strategy = PartitionStrategy::LDG;
+    else return false;
+    return true;
+}
+
+// Split of the global id space into one contiguous range per rank.
+// Every strategy ends up here: the ones that scatter vertices (hash, ldg) relabel them first,
+// so algorithms can keep indexing local vertices as global_id - rangeStart(rank).
+// Owner lookup is O(1) for equal ranges and a binary search over P boundaries otherwise.
+class Partition {
+public:
+    Partition() = default;
+
+    // Equal ranges; the first (n mod parts) ranks get one extra vertex
+    static Partition uniform(VertexId n, int parts) {
+        Partition p;
+        p.uniform_ = true;
+        p.chunk_ = n / parts;
+        p.remainder_ = n % parts;
+        p.starts_.resize(parts + 1);
+        for (int r = 0; r <= parts; ++r) {
+            VertexId rr = static_cast<VertexId>(r);
+            p.starts_[r] = rr * p.chunk_ + std::min(rr, p.remainder_);
+        }
+        return p;
+    }
+
+    // Arbitrary ranges: starts has parts + 1 non-decreasing entries, the last one being n
+    static Partition fromBoundaries(std::vector<VertexId> starts) {
+        Partition p;
+        p.starts_ = std::move(starts);
+        return p;
+    }
+
+    int numParts() const { return static_cast<int>(starts_.size()) - 1; }
+    VertexId numVertices() const { return starts_.empty() ? 0 : starts_.back(); }
+
+    int ownerOf(VertexId vid) const {
+        if (uniform_) {
+            VertexId split_point = remainder_ * (chunk_ + 1);
+            if (vid < split_point) return static_cast<int>(vid / (chunk_ + 1));
+            return static_cast<int>(remainder_ + (vid - split_point) / chunk_);
+        }
+        // Last rank whose range starts at or before vid (empty ranks are skipped over)
+        auto it = std::upper_bound(starts_.begin() + 1, starts_.end() - 1, vid);
+        return static_cast<int>(it - starts_.begin()) - 1;
+    }
+
+    VertexId rangeStart(int rank) const { return starts_[rank]; }
+    VertexId rangeEnd(int rank) const { return starts_[rank + 1]; }
+    VertexId rangeSize(int rank) const { return starts_[rank + 1] - starts_[rank]; }
+
+    VertexId toLocal(VertexId vid) const { return vid - starts_[ownerOf(vid)]; }
+    VertexId toGlobal(int rank, VertexId local_id) const { return starts_[rank] + local_id; }
+
+private:
+    std::vector<VertexId> starts_;
+    bool uniform_ = false;
+    VertexId chunk_ = 0;
+    VertexId remainder_ = 0;
+};
+
+} // namespace dgraph
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Graph.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace dgraph {
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy
+// as 1, 2, 3"). Every draw is a pure function of (key, counter), so a walk can name its
+// random numbers by (walk, step, trial) and get the same ones on any rank or thread.
+class Philox4x32 {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit Philox4x32(uint64_t seed)
+        : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+    Block operator()(Block counter) const {
+        uint32_t k0 = key_[0], k1 = key_[1];
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+            uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ k0, static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ k1, static_cast<uint32_t>(p0)};
+        }
+        return counter;
+    }
+
+    // Convenience counter layout used by the walkers: 64-bit stream id, then two 32-bit words
+    Block operator()(uint64_t stream, uint32_t a, uint32_t b) const {
+        return (*this)({static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32), a, b});
+    }
+
+    // [0, 1) from one output word
+    static double unit(uint32_t word) { return word * (1.0 / 4294967296.0); }
+
+private:
+    std::array<uint32_t, 2> key_;
+};
+
+// Walker/Vose alias tables over the weighted out-edges of every local vertex: O(degree) to
+// build, O(1) per draw. Entries are stored edge-parallel to the CSR, the alias being the
+// position within the row. Rows whose weights are all zero (or negative) sample uniformly.
+class AliasTable {
+public:
+    void build(const Graph& graph) {
+        ArrayView<uint64_t> row_ptr = graph.getRowPtr();
+        ArrayView<EdgeWeight> weights = graph.getWeights();
+        const VertexId num_local = graph.numLocalVertices();
+        prob_.assign(weights.size(), 1.0f);
+        alias_.resize(weights.size());
+
+        #pragma omp parallel
+        {
+            std::vector<double> scaled;
+            std::vector<uint32_t> small, large;
+
+            #pragma omp for schedule(dynamic, 1024)
+            for (VertexId i = 0; i < num_local; ++i) {
+                const uint64_t begin = row_ptr[i];
+                const uint32_t degree = static_cast<uint32_t>(row_ptr[i + 1] - begin);
+                for (uint32_t k = 0; k < degree; ++k) alias_[begin + k] = k;
+                if (degree < 2) continue;
+
+                double total = 0.0;
+                for (uint32_t k = 0; k < degree; ++k) total += std::max(0.0f, weights[begin + k]);
+                if (!(total > 0.0) || !std::isfinite(total)) continue;
+
+                scaled.resize(degree);
+                small.clear();
+                large.clear();
+                for (uint32_t k = 0; k < degree; ++k) {
+                    scaled[k] = std::max(0.0f, weights[begin + k]) * degree / total;
+                    (scaled[k] < 1.0 ? small : large).push_back(k);
+                }
+                while (!small.empty() && !large.empty()) {
+                    uint32_t s = small.back(), l = large.back();
+                    small.pop_back();
+                    prob_[begin + s] = static_cast<float>(scaled[s]);
+                    alias_[begin + s] = l;
+                    scaled[l] -= 1.0 - scaled[s];
+                    if (scaled[l] < 1.0) {
+                        large.pop_back();
+                        small.push_back(l);
+                    }
+                }
+                // Leftovers are 1 up to rounding
+                for (uint32_t k : small) prob_[begin + k] = 1.0f;
+                for (uint32_t k : large) prob_[begin + k] = 1.0f;
+            }
+        }
+    }
+
+    bool empty() const { return alias_.empty(); }
+
+    // Position within a row (starting at CSR offset row_begin, degree > 0) from a uniform
+    // 64-bit value and a coin in [0, 1)
+    uint64_t sample(uint64_t row_begin, uint64_t degree, uint64_t uniform, double coin) const {
+        uint64_t k = uniform % degree;
+        return coin < prob_[row_begin + k] ? k : alias_[row_begin + k];
+    }
+
+private:
+    std::vector<float> prob_;
+    std::vector<uint32_t> alias_;
+};
+
+} // namespace dgraph
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dgraph {
+
+// On-disk binary CSR snapshot layout (native endianness).
+//
+//   [SnapshotHeader]
+//   [SnapshotPartition x num_partitions]
+//   per partition, each section starting on a kSnapshotAlignment boundary:
+//     row_ptr  : uint64_t x (num_vertices + 1)   (partition-local, starts at 0)
+//     col_ind  : VertexId x num_edges            (global vertex ids)
+//     weights  : EdgeWeight x num_edges
+//
+// Partition p holds the CSR slice of the rank that owned it when the snapshot
+// was written, so a run with the same number of ranks can mmap its slice
+// directly instead of parsing anything.
+
+constexpr char kSnapshotMagic[8] = {'D', 'G', 'C', 'S', 'R', 'S', 'N', 'P'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr uint64_t kSnapshotAlignment = 4096;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_partitions;
+    uint64_t num_vertices;     // Global
+    uint64_t num_edges;        // Global
+    uint64_t partition_strategy; // PartitionStrategy the ranges were computed with
+    uint64_t reserved[3];
+};
+
+struct SnapshotPartition {
+    uint64_t start_vertex;     // Inclusive
+    uint64_t end_vertex;       // Exclusive
+    uint64_t num_edges;
+    uint64_t row_ptr_offset;   // Byte offsets from start of file
+    uint64_t col_ind_offset;
+    uint64_t weights_offset;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader layout changed");
+static_assert(sizeof(SnapshotPartition) == 48, "SnapshotPartition layout changed");
+
+inline uint64_t alignSnapshotOffset(uint64_t offset) {
+    return (offset + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+}
+
+} // namespace dgraph
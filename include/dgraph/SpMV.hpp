@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Types.hpp"
+#include <cstdint>
+#include <string>
+
+namespace dgraph {
+
+// Kernels for the pull-mode inner loop: sums[i] = sum of values[sources[e]] over the
+// in-edges e of row i. The SIMD kernels gather 4 doubles or 8 floats (AVX2), or 8 of either
+// (AVX-512), per instruction with 32-bit indices; which ones are available is decided at run
+// time, so the binary needs no -march flag and still runs on CPUs without them. Every kernel
+// accumulates in double, and rows shorter than one vector take the scalar loop.
+enum class SpmvKernel {
+    Auto,   // Fastest kernel on the actual index, measured (see fastestSpmvKernel)
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+inline const char* spmvKernelName(SpmvKernel kernel) {
+    switch (kernel) {
+        case SpmvKernel::Scalar: return "scalar";
+        case SpmvKernel::AVX2: return "avx2";
+        case SpmvKernel::AVX512: return "avx512";
+        default: return "auto";
+    }
+}
+
+inline bool parseSpmvKernel(const std::string& name, SpmvKernel& kernel) {
+    if (name == "auto") kernel = SpmvKernel::Auto;
+    else if (name == "scalar") kernel = SpmvKernel::Scalar;
+    else if (name == "avx2") kernel = SpmvKernel::AVX2;
+    else if (name == "avx512") kernel = SpmvKernel::AVX512;
+    else return false;
+    return true;
+}
+
+bool spmvKernelSupported(SpmvKernel kernel);
+
+// Unsupported requests fall back to scalar; Auto is returned as is for the caller to measure
+SpmvKernel resolveSpmvKernel(SpmvKernel kernel);
+
+// The supported kernel that gathers a sample of rows [0, num_rows) fastest on this CPU, timed
+// single-threaded. Wider is not always faster: on short rows the scalar loop usually wins.
+// Overwrites sums; the same 2^31 limit as gatherSum applies.
+SpmvKernel fastestSpmvKernel(const uint64_t* row_ptr, const uint32_t* sources, const double* values,
+                             double* sums, VertexId num_rows);
+SpmvKernel fastestSpmvKernel(const uint64_t* row_ptr, const uint32_t* sources, const float* values,
+                             float* sums, VertexId num_rows);
+
+// Rows [row_begin, row_end) of the CSC index given by row_ptr/sources. `kernel` must not be
+// Auto, and must be Scalar unless every source is below 2^31: the gathers take signed 32-bit
+// indices (Engine::runPullSum falls back on its own).
+void gatherSum(SpmvKernel kernel, const uint64_t* row_ptr, const uint32_t* sources, const double* values,
+               double* sums, VertexId row_begin, VertexId row_end);
+void gatherSum(SpmvKernel kernel, const uint64_t* row_ptr, const uint32_t* sources, const float* values,
+               float* sums, VertexId row_begin, VertexId row_end);
+
+} // namespace dgraph
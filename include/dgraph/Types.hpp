@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <iostream>
 
@@ -16,4 +17,29 @@ struct Edge {
     EdgeWeight weight;
 };
 
+// Read-only view over a contiguous array.
+// Graph hands these out so the CSR arrays can live either in owned vectors
+// or directly inside a memory-mapped snapshot file.
+template <typename T>
+class ArrayView {
+public:
+    ArrayView() = default;
+    ArrayView(const T* data, size_t size) : data_(data), size_(size) {}
+    ArrayView(const std::vector<T>& vec) : data_(vec.data()), size_(vec.size()) {}
+
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T& operator[](size_t i) const { return data_[i]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
 } // namespace dgraph
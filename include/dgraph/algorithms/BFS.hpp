@@ -5,103 +5,208 @@
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 
 namespace dgraph {
 
 class BFS {
 public:
+    enum class Direction {
+        TopDown,  // Push from the frontier every level
+        Auto      // Direction-optimizing: switch to bottom-up pull on large frontiers
+    };
+
     BFS(Graph& graph) : graph_(graph), engine_(graph) {}
 
-    std::vector<uint64_t> compute(VertexId source_node, int max_iterations = 100) {
+    // Fold messages to the same destination vertex before they are exchanged
+    void setSenderCombining(bool enabled) { engine_.setSenderCombining(enabled); }
+    void setAsyncExchange(bool enabled) { engine_.setAsyncExchange(enabled); }
+
+    std::vector<uint64_t> compute(VertexId source_node, int max_iterations = 100,
+                                  Direction direction = Direction::TopDown) {
         VertexId num_local = graph_.numLocalVertices();
         VertexId start_id = graph_.globalStartId();
         
         const uint64_t INF = std::numeric_limits<uint64_t>::max();
         std::vector<uint64_t> dist(num_local, INF);
         
-        // Initialize source
-        VertexId local_source = -1;
+        // Initialize source; it is the only active vertex of level 0
+        Frontier frontier(num_local);
         if (source_node >= start_id && source_node < start_id + num_local) {
-            local_source = source_node - start_id;
+            VertexId local_source = source_node - start_id;
             dist[local_source] = 0;
+            frontier.insert(local_source);
         }
+        frontier.finalize();
+
+        // Min-combine candidate distances; INF is the identity
+        auto min_dist = makeCombiner<uint64_t>(INF, [](uint64_t& acc, const uint64_t& val) {
+            if (val < acc) acc = val;
+        });
+
+        // Scatter: only the current frontier expands, sending (dist + 1) to neighbors
+        auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<uint64_t>>>& buffers) {
+            uint64_t new_dist = dist[local_id] + 1;
+            for (VertexId global_dst : graph_.neighbors(local_id)) {
+                int owner = engine_.getOwner(global_dst);
+                buffers[owner].push_back({global_dst, new_dist});
+            }
+        };
+
+        // Newly reached vertices form the next frontier (called concurrently for distinct vertices)
+        auto apply = [&](VertexId global_dst, const uint64_t& val) {
+            VertexId local_idx = global_dst - start_id;
+            if (val < dist[local_idx]) {
+                dist[local_idx] = val;
+                return true;
+            }
+            return false;
+        };
+
+        // Beamer's heuristics: go bottom-up once a growing frontier's out-edges exceed 1/alpha of
+        // the edges still unexplored, and back top-down once it holds fewer than n/beta vertices.
+        const double alpha = 14.0;
+        const double beta = 24.0;
+        bool bottom_up = false;
+        uint64_t unexplored_edges = globalSum(graph_.numLocalEdges());
+        uint64_t local_examined = 0;
+        auto start_time = std::chrono::steady_clock::now();
 
-        // Boolean to track convergence
-        bool changed = true;
         int iter = 0;
-        
-        while (changed && iter < max_iterations) {
-            changed = false;
-            int local_changed = 0;
-
-            // Scatter: If I have a valid distance, send (dist + 1) to neighbors
-            // Optimization: Only send if I just updated my distance? 
-            // For simple BSP, we can just send if dist != INF.
-            // Better: active list. But Engine scans all.
-            // We can check if dist == iter. (Level-sync).
-            // Yes, BFS only propagates if dist == iter.
-            
-            auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<uint64_t>>>& buffers) {
-                if (dist[local_id] == (uint64_t)iter) { // Only active frontier expands
-                    uint64_t new_dist = dist[local_id] + 1;
-                    auto neighbors = graph_.getNeighbors(local_id);
-                    for (const VertexId* it = neighbors.first; it != neighbors.second; ++it) {
-                        VertexId global_dst = *it;
-                        int owner = engine_.getOwner(global_dst);
-                        buffers[owner].push_back({global_dst, new_dist});
-                    }
-                }
-            };
-
-            auto reduce = [&](DistWrapper& acc, const uint64_t& val) {
-                if (val < acc.d) acc.d = val;
-            };
-
-            auto apply = [&](VertexId global_dst, const DistWrapper& val) {
-                VertexId local_idx = global_dst - start_id;
-                if (local_idx < num_local) {
-                    if (val.d < dist[local_idx]) {
-                        dist[local_idx] = val.d;
-                        local_changed = 1;
-                    }
+        VertexId frontier_size = engine_.globalFrontierSize(frontier);
+        VertexId previous_size = 0;
+        while (iter < max_iterations && frontier_size > 0) {
+            uint64_t local_frontier_edges = 0;
+            frontier.forEach([&](VertexId v) { local_frontier_edges += graph_.getOutDegree(v); });
+            uint64_t frontier_edges = globalSum(local_frontier_edges);
+            unexplored_edges -= frontier_edges;
+
+            if (direction == Direction::Auto) {
+                if (!bottom_up && frontier_size > previous_size && frontier_edges > unexplored_edges / alpha) {
+                    bottom_up = true;
+                } else if (bottom_up && frontier_size < graph_.numGlobalVertices() / beta) {
+                    bottom_up = false;
                 }
-            };
-
-            // Run 1 iteration
-            // Note: reduce init value should be INF
-            // But Engine default constructs AccT. uint64_t default is 0? No, undefined or 0.
-            // We need to handle this. Engine code: "accumulator = AccT(); // Reset".
-            // If AccT is uint64_t, it's 0.
-            // This is a problem for min-reduction. 
-            // Fix: Change MsgT/AccT to a struct with constructor, or handle 0 in reduce?
-            // Or change Engine to allow init value.
-            // Workaround: Use a wrapper struct for BFS Message.
-            
-            engine_.run(1, scatter, reduce, apply);
-
-            // Check global convergence
-            int global_changed = 0;
-            MPI_Allreduce(&local_changed, &global_changed, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-            changed = (global_changed > 0);
-            
+            }
+
+            if (bottom_up) {
+                local_examined += bottomUpStep(frontier, dist, iter);
+            } else {
+                engine_.runFrontier(frontier, scatter, min_dist, apply);
+                local_examined += local_frontier_edges;
+            }
+
+            if (graph_.getRank() == 0) {
+                std::cout << "BFS level " << iter << ": " << (bottom_up ? "bottom-up" : "top-down")
+                          << ", frontier " << frontier_size << std::endl;
+            }
+            previous_size = frontier_size;
+            frontier_size = engine_.globalFrontierSize(frontier);
             iter++;
         }
 
+        // TEPS, Graph500 style: edges of the reached vertices over wall time
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        uint64_t local_traversed = 0;
+        for (VertexId i = 0; i < num_local; ++i) {
+            if (dist[i] != INF) local_traversed += graph_.getOutDegree(i);
+        }
+        uint64_t traversed = globalSum(local_traversed);
+        uint64_t examined = globalSum(local_examined);
+        if (graph_.getRank() == 0) {
+            std::cout << "BFS finished: " << iter << " levels in " << elapsed << " s, "
+                      << traversed << " edges traversed (" << examined << " examined), "
+                      << (elapsed > 0 ? traversed / elapsed / 1e6 : 0.0) << " MTEPS" << std::endl;
+        }
+
         return dist;
     }
 
 private:
+    uint64_t globalSum(uint64_t local) const {
+        uint64_t global = 0;
+        MPI_Allreduce(&local, &global, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        return global;
+    }
+
+    // Where each rank's frontier words land in the gathered global bitmap, and the
+    // bit of every ghost slot of the in-edge index within it. Built once.
+    void prepareBottomUp() {
+        if (!graph_.hasInEdges()) graph_.buildInEdges();
+        if (!ghost_bit_.empty() || !word_displs_.empty()) return;
+
+        int size = graph_.getSize();
+        uint64_t mine[2] = {graph_.globalStartId(), graph_.numLocalVertices()};
+        std::vector<uint64_t> all(2 * size);
+        MPI_Allgather(mine, 2, MPI_UINT64_T, all.data(), 2, MPI_UINT64_T, MPI_COMM_WORLD);
+
+        word_counts_.resize(size);
+        word_displs_.resize(size);
+        std::vector<uint64_t> starts(size);
+        int offset = 0;
+        for (int r = 0; r < size; ++r) {
+            starts[r] = all[2 * r];
+            word_counts_[r] = static_cast<int>((all[2 * r + 1] + 63) / 64);
+            word_displs_[r] = offset;
+            offset += word_counts_[r];
+        }
+        global_bits_.resize(offset);
+
+        const InEdgeIndex& in = graph_.getInEdges();
+        ghost_bit_.resize(in.numGhosts());
+        for (VertexId k = 0; k < in.numGhosts(); ++k) {
+            VertexId g = in.ghost_ids[k];
+            int owner = graph_.ownerOf(g);
+            ghost_bit_[k] = static_cast<uint64_t>(word_displs_[owner]) * 64 + (g - starts[owner]);
+        }
+    }
+
+    // One bottom-up level: every unvisited local vertex looks for a parent in the
+    // (globally gathered) frontier and stops at the first hit. Returns edges examined.
+    uint64_t bottomUpStep(Frontier& frontier, std::vector<uint64_t>& dist, int level) {
+        prepareBottomUp();
+        const InEdgeIndex& in = graph_.getInEdges();
+        const VertexId num_local = graph_.numLocalVertices();
+        const uint64_t INF = std::numeric_limits<uint64_t>::max();
+
+        MPI_Allgatherv(frontier.bitmap().data(), word_counts_[graph_.getRank()], MPI_UINT64_T,
+                       global_bits_.data(), word_counts_.data(), word_displs_.data(), MPI_UINT64_T,
+                       MPI_COMM_WORLD);
+
+        Frontier next(num_local);
+        uint64_t examined = 0;
+
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(+:examined)
+        for (VertexId v = 0; v < num_local; ++v) {
+            if (dist[v] != INF) continue;
+            for (uint64_t e = in.row_ptr[v]; e < in.row_ptr[v + 1]; ++e) {
+                uint32_t slot = in.sources[e];
+                examined++;
+                bool active = (slot < num_local)
+                    ? frontier.contains(slot)
+                    : (global_bits_[ghost_bit_[slot - num_local] >> 6] >> (ghost_bit_[slot - num_local] & 63)) & 1ULL;
+                if (active) {
+                    dist[v] = level + 1;
+                    next.insert(v);
+                    break;
+                }
+            }
+        }
+
+        next.finalize();
+        frontier.swap(next);
+        return examined;
+    }
+
     Graph& graph_;
-    // MsgT = uint64_t (distance). AccT needs to default to INF?
-    // Since Engine default constructs AccT, we need a wrapper.
-    struct DistWrapper {
-        uint64_t d;
-        DistWrapper() : d(std::numeric_limits<uint64_t>::max()) {}
-        DistWrapper(uint64_t val) : d(val) {}
-        bool operator<(const DistWrapper& other) const { return d < other.d; }
-    };
-    
-    Engine<uint64_t, DistWrapper> engine_;
+    Engine<uint64_t> engine_;
+
+    // Bottom-up state
+    std::vector<int> word_counts_;
+    std::vector<int> word_displs_;
+    std::vector<uint64_t> global_bits_;
+    std::vector<uint64_t> ghost_bit_;
 };
 
 } // namespace dgraph
@@ -10,65 +10,76 @@ namespace dgraph {
 
 class ConnectedComponents {
 public:
+    enum class Mode {
+        Push,   // Frontier supersteps: only vertices whose label dropped send it again
+        Grid    // Dense gather-apply-scatter supersteps over the 2D edge grid
+    };
+
     ConnectedComponents(Graph& graph) : graph_(graph), engine_(graph) {}
 
-    std::vector<VertexId> compute(int max_iterations = 100) {
+    // Fold messages to the same destination vertex before they are exchanged
+    void setSenderCombining(bool enabled) { engine_.setSenderCombining(enabled); }
+    void setAsyncExchange(bool enabled) { engine_.setAsyncExchange(enabled); }
+
+    // Labels are input-file ids (Graph::originalId), so results do not depend on the layout
+    std::vector<VertexId> compute(int max_iterations = 100, Mode mode = Mode::Push) {
         VertexId num_local = graph_.numLocalVertices();
         VertexId start_id = graph_.globalStartId();
         
-        // Init component ID to self
+        // Init component ID to self, by input-file id: the minimum that propagates must not
+        // depend on how repartition() or reorder() numbered the vertices
         std::vector<VertexId> cc(num_local);
         for(VertexId i=0; i<num_local; ++i) {
-            cc[i] = start_id + i;
+            cc[i] = graph_.originalId(i);
         }
 
-        bool changed = true;
-        int iter = 0;
-        
-        while (changed && iter < max_iterations) {
-            changed = false;
-            int local_changed = 0;
+        // Every vertex starts active; afterwards only vertices whose label dropped re-send it
+        Frontier frontier(num_local);
+        frontier.fill();
 
-            auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<VertexId>>>& buffers) {
-                // Optimization: In standard CC, we always send our Component ID to neighbors.
-                // Or better: Only send if my Component ID changed recently?
-                // For simplicity, always send current CC ID.
-                // Optimization 2: Min-label propagation.
-                
-                VertexId current_cc = cc[local_id];
-                // Only send if I am smaller than neighbors? We don't know neighbors' values.
-                // Just broadcast current_cc.
-                
-                auto neighbors = graph_.getNeighbors(local_id);
-                for (const VertexId* it = neighbors.first; it != neighbors.second; ++it) {
-                    VertexId global_dst = *it;
-                    int owner = engine_.getOwner(global_dst);
-                    // Optimization: Don't send if dst < current_cc (dst is definitely smaller/equal if it's its own ID).
-                    // But we can't know dst's current state.
-                    
-                    buffers[owner].push_back({global_dst, current_cc});
-                }
-            };
+        auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<VertexId>>>& buffers) {
+            VertexId current_cc = cc[local_id];
+            for (VertexId global_dst : graph_.neighbors(local_id)) {
+                int owner = engine_.getOwner(global_dst);
+                buffers[owner].push_back({global_dst, current_cc});
+            }
+        };
 
-            auto reduce = [&](MinIdWrapper& acc, const VertexId& val) {
-                if (val < acc.id) acc.id = val;
-            };
+        auto min_label = makeCombiner<VertexId>(std::numeric_limits<VertexId>::max(),
+                                                [](VertexId& acc, const VertexId& val) {
+                                                    if (val < acc) acc = val;
+                                                });
 
-            auto apply = [&](VertexId global_dst, const MinIdWrapper& val) {
-                VertexId local_idx = global_dst - start_id;
-                if (local_idx < num_local) {
-                    if (val.id < cc[local_idx]) {
-                        cc[local_idx] = val.id;
-                        local_changed = 1;
-                    }
-                }
-            };
+        // Called concurrently for distinct vertices
+        auto apply = [&](VertexId global_dst, const VertexId& val) {
+            VertexId local_idx = global_dst - start_id;
+            if (val < cc[local_idx]) {
+                cc[local_idx] = val;
+                return true;
+            }
+            return false;
+        };
 
-            engine_.run(1, scatter, reduce, apply);
+        int iter = 0;
+        if (mode == Mode::Grid) {
+            auto value = [&](VertexId local_id) { return cc[local_id]; };
+            uint64_t changed = 1;
+            while (iter < max_iterations && changed > 0) {
+                uint64_t local_changed = 0;
+                engine_.runGrid(1, value, min_label, [&](VertexId global_dst, const VertexId& val) {
+                    if (apply(global_dst, val)) {
+                        #pragma omp atomic
+                        local_changed++;
+                    }
+                });
+                MPI_Allreduce(&local_changed, &changed, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+                iter++;
+            }
+            return cc;
+        }
 
-            int global_changed = 0;
-            MPI_Allreduce(&local_changed, &global_changed, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-            changed = (global_changed > 0);
+        while (iter < max_iterations && engine_.globalFrontierSize(frontier) > 0) {
+            engine_.runFrontier(frontier, scatter, min_label, apply);
             iter++;
         }
 
@@ -77,14 +88,7 @@ public:
 
 private:
     Graph& graph_;
-    
-    struct MinIdWrapper {
-        VertexId id;
-        MinIdWrapper() : id(std::numeric_limits<VertexId>::max()) {}
-        MinIdWrapper(VertexId val) : id(val) {}
-    };
-
-    Engine<VertexId, MinIdWrapper> engine_;
+    Engine<VertexId> engine_;
 };
 
 } // namespace dgraph
@@ -3,95 +3,160 @@
 #include "../Graph.hpp"
 #include "../Engine.hpp"
 #include <vector>
-#include <map>
-#include <random>
+#include <chrono>
+#include <iostream>
+#include <limits>
 #include <algorithm>
 
 namespace dgraph {
 
+// Open-addressing label -> count table, reused across vertices by one thread.
+// Only the slots touched by the current vertex are cleared, so a reset costs
+// O(distinct labels), and the table only reallocates when a vertex needs more room.
+class LabelCounter {
+public:
+    // Make room for up to n distinct labels and start counting a new vertex
+    void reset(size_t n) {
+        for (size_t slot : used_) keys_[slot] = kEmpty;
+        used_.clear();
+
+        size_t capacity = 16;
+        while (capacity < 2 * n) capacity <<= 1;
+        if (capacity > keys_.size()) {
+            keys_.assign(capacity, kEmpty);
+            counts_.resize(capacity);
+            used_.reserve(capacity);
+            allocations_++;
+        }
+    }
+
+    void add(VertexId label) {
+        const size_t mask = keys_.size() - 1;
+        size_t h = (label * 0x9E3779B97F4A7C15ULL) >> 17 & mask;
+        while (keys_[h] != kEmpty && keys_[h] != label) h = (h + 1) & mask;
+        if (keys_[h] == kEmpty) {
+            keys_[h] = label;
+            counts_[h] = 0;
+            used_.push_back(h);
+        }
+        counts_[h]++;
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t slot : used_) fn(keys_[slot], counts_[slot]);
+    }
+
+    // Number of times the table had to grow, i.e. heap allocations made
+    uint64_t allocations() const { return allocations_; }
+
+private:
+    static constexpr VertexId kEmpty = std::numeric_limits<VertexId>::max();
+
+    std::vector<VertexId> keys_;
+    std::vector<uint32_t> counts_;
+    std::vector<size_t> used_;
+    uint64_t allocations_ = 0;
+};
+
 class LabelPropagation {
 public:
+    // How to pick among labels with the same (maximum) count
+    enum class TieBreak {
+        Smallest, // Smallest label id wins (deterministic, the original behavior)
+        Random    // Hash of (label, vertex, iteration): random-looking but reproducible
+    };
+
     LabelPropagation(Graph& graph) : graph_(graph), engine_(graph) {}
 
-    std::vector<VertexId> compute(int iterations = 10) {
+    // Labels are input-file ids (Graph::originalId), like ConnectedComponents
+    std::vector<VertexId> compute(int iterations = 10, TieBreak ties = TieBreak::Smallest) {
         VertexId num_local = graph_.numLocalVertices();
         VertexId start_id = graph_.globalStartId();
-        
-        // Initialize labels: each vertex is its own community
+
+        // Initialize labels: each vertex is its own community, named by its input-file id so
+        // that tie-breaks do not depend on the vertex layout
         std::vector<VertexId> labels(num_local);
         #pragma omp parallel for
         for (VertexId i = 0; i < num_local; ++i) {
-            labels[i] = start_id + i;
+            labels[i] = graph_.originalId(i);
         }
 
-        // Engine Accumulator Type: Map of Label -> Count
-        using AccT = std::map<VertexId, int>;
+        // One counter per thread, reused for every vertex that thread applies
+        std::vector<LabelCounter> counters(omp_get_max_threads());
+        std::vector<VertexId> next_labels(num_local);
+
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
         for (int iter = 0; iter < iterations; ++iter) {
-            
+            auto iter_start = std::chrono::steady_clock::now();
+            uint64_t allocations_before = 0;
+            for (const auto& c : counters) allocations_before += c.allocations();
+
             auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<VertexId>>>& buffers) {
                 VertexId my_label = labels[local_id];
-                auto neighbors = graph_.getNeighbors(local_id);
-                
-                for (const VertexId* it = neighbors.first; it != neighbors.second; ++it) {
-                    VertexId global_dst = *it;
+                for (VertexId global_dst : graph_.neighbors(local_id)) {
                     int owner = engine_.getOwner(global_dst);
                     buffers[owner].push_back({global_dst, my_label});
                 }
             };
 
-            auto reduce = [&](AccT& acc, const VertexId& label) {
-                acc[label]++;
-            };
+            // Synchronous update: vertices without incoming labels keep their own
+            std::copy(labels.begin(), labels.end(), next_labels.begin());
+
+            auto apply = [&](VertexId global_dst, const VertexId* received, size_t count) {
+                VertexId local_idx = global_dst - start_id;
+                LabelCounter& counter = counters[omp_get_thread_num()];
+                counter.reset(count);
+                for (size_t k = 0; k < count; ++k) counter.add(received[k]);
 
-            // Temporary storage for synchronous update
-            // We only update vertices that received messages (neighbors).
-            // But if a vertex has no neighbors, it keeps its label.
-            // Engine apply is only called for vertices with incoming messages.
-            std::vector<VertexId> next_labels = labels;
-
-            auto apply = [&](VertexId global_dst, const AccT& acc) {
-                VertexId local_idx = global_dst - graph_.globalStartId();
-                if (local_idx < num_local) {
-                    // Find label with max count
-                    VertexId best_label = labels[local_idx]; // Default to current
-                    int max_count = -1;
-                    
-                    // Tie-breaking: Use smallest label ID for determinism, or random.
-                    // Map iterates in sorted order of Key (Label), so simple traversal works for deterministic lowest ID.
-                    
-                    for (const auto& pair : acc) {
-                        if (pair.second > max_count) {
-                            max_count = pair.second;
-                            best_label = pair.first;
-                        } else if (pair.second == max_count) {
-                            // Tie: stick with current if it's one of them?
-                            // Or strictly lowest?
-                            // Standard LPA often says random. 
-                            // For this implementation, lowest label ID (map order) wins on tie if we use >.
-                            // But we initialized best_label to current.
-                            // Let's just pick the max count one.
-                        }
+                // Find label with max count
+                VertexId best_label = labels[local_idx];
+                uint32_t max_count = 0;
+                uint64_t best_key = std::numeric_limits<uint64_t>::max();
+                counter.forEach([&](VertexId label, uint32_t c) {
+                    uint64_t key = (ties == TieBreak::Smallest) ? label : tieHash(label, graph_.originalId(local_idx), iter);
+                    if (c > max_count || (c == max_count && key < best_key)) {
+                        max_count = c;
+                        best_key = key;
+                        best_label = label;
                     }
-                    next_labels[local_idx] = best_label;
-                }
+                });
+                next_labels[local_idx] = best_label;
             };
 
-            engine_.run(1, scatter, reduce, apply);
-            
-            labels = std::move(next_labels);
-            
-            int rank;
-            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-            if (rank == 0) std::cout << "LPA Iteration " << iter + 1 << " complete." << std::endl;
+            engine_.runGrouped(1, scatter, apply);
+
+            labels.swap(next_labels);
+
+            uint64_t allocations = 0;
+            for (const auto& c : counters) allocations += c.allocations();
+            allocations -= allocations_before;
+            uint64_t global_allocations = 0;
+            MPI_Allreduce(&allocations, &global_allocations, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - iter_start).count();
+            if (rank == 0) {
+                std::cout << "LPA Iteration " << iter + 1 << " complete. (" << elapsed << " s, "
+                          << global_allocations << " counter allocations)" << std::endl;
+            }
         }
-        
+
         return labels;
     }
 
 private:
+    // splitmix64 finalizer over the (label, vertex, iteration) triple
+    static uint64_t tieHash(VertexId label, VertexId vertex, int iter) {
+        uint64_t x = label ^ (vertex * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(iter) << 48);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
     Graph& graph_;
-    Engine<VertexId, std::map<VertexId, int>> engine_;
+    Engine<VertexId> engine_;
 };
 
 } // namespace dgraph
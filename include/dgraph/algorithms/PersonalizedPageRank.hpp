@@ -0,0 +1,259 @@
+#pragma once
+
+#include "../Graph.hpp"
+#include "../Engine.hpp"
+#include "../Exchange.hpp"
+#include "../Frontier.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace dgraph {
+
+// The values of one vertex for every query of a batch. Pull mode folds them lane by lane,
+// so each in-edge read serves all kWidth queries and the fold compiles to vector adds
+// (one AVX-512 or two AVX2 registers of doubles).
+struct PPRLanes {
+    static constexpr int kWidth = 8;
+    alignas(64) double v[kWidth];
+};
+
+// A query: the vertices (global ids) that walks restart from, chosen uniformly
+using SeedSet = std::vector<VertexId>;
+
+struct PPRScore {
+    VertexId vertex;  // Input-file id
+    double score;
+};
+
+class PersonalizedPageRank {
+public:
+    PersonalizedPageRank(Graph& graph) : graph_(graph), batch_engine_(graph), push_engine_(graph) {}
+
+    // Power iteration for up to PPRLanes::kWidth queries at once, pulled over the in-edge index.
+    // Walks restart at their query's seed set with probability 1 - damping, and mass reaching a
+    // dangling vertex restarts there too, so every lane sums to 1. Stops after max_iterations or
+    // once no lane moves by more than tolerance (L1). Lane q of the result belongs to seeds[q].
+    std::vector<PPRLanes> computeBatch(const std::vector<SeedSet>& seeds, int max_iterations = 50,
+                                       double damping = 0.85, double tolerance = 1e-6) {
+        if (seeds.size() > static_cast<size_t>(PPRLanes::kWidth)) {
+            throw std::runtime_error("A PPR batch holds at most " + std::to_string(PPRLanes::kWidth) + " queries");
+        }
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const PPRLanes zero{};
+
+        // Restart targets owned here: (local id, lane, share of the restart mass)
+        struct Restart {
+            VertexId local_id;
+            int lane;
+            double share;
+        };
+        std::vector<Restart> restarts;
+        for (size_t q = 0; q < seeds.size(); ++q) {
+            if (seeds[q].empty()) throw std::runtime_error("PPR query without seeds");
+            for (VertexId s : seeds[q]) {
+                if (graph_.ownerOf(s) == graph_.getRank()) {
+                    restarts.push_back({s - start_id, static_cast<int>(q), 1.0 / seeds[q].size()});
+                }
+            }
+        }
+
+        std::vector<VertexId> dangling;
+        for (VertexId i = 0; i < num_local; ++i) {
+            if (graph_.getOutDegree(i) == 0) dangling.push_back(i);
+        }
+
+        std::vector<PPRLanes> values(num_local, zero), next(num_local);
+        for (const Restart& r : restarts) values[r.local_id].v[r.lane] += r.share;
+
+        const std::vector<double>& inv_degree = graph_.inverseOutDegrees();
+        auto value = [&](VertexId local_id) {
+            const double inverse = inv_degree[local_id];
+            PPRLanes out;
+            for (int l = 0; l < PPRLanes::kWidth; ++l) out.v[l] = values[local_id].v[l] * inverse;
+            return out;
+        };
+        auto reduce = [](PPRLanes& acc, const PPRLanes& val) {
+            for (int l = 0; l < PPRLanes::kWidth; ++l) acc.v[l] += val.v[l];
+        };
+        auto apply = [&](VertexId global_dst, const PPRLanes& sum) {
+            PPRLanes& out = next[global_dst - start_id];
+            for (int l = 0; l < PPRLanes::kWidth; ++l) out.v[l] = damping * sum.v[l];
+        };
+
+        int iter = 0;
+        double max_change = 0.0;
+        while (iter < max_iterations) {
+            PPRLanes local_dangling = zero, global_dangling;
+            for (VertexId i : dangling) reduce(local_dangling, values[i]);
+            MPI_Allreduce(local_dangling.v, global_dangling.v, PPRLanes::kWidth, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+            // Vertices without in-edges are never applied; they only keep their restart mass
+            #pragma omp parallel for
+            for (VertexId i = 0; i < num_local; ++i) next[i] = zero;
+            batch_engine_.runPull(1, value, reduce, apply);
+            for (const Restart& r : restarts) {
+                next[r.local_id].v[r.lane] += r.share * ((1.0 - damping) + damping * global_dangling.v[r.lane]);
+            }
+
+            PPRLanes local_change = zero, change;
+            #pragma omp parallel
+            {
+                PPRLanes mine = zero;
+                #pragma omp for nowait
+                for (VertexId i = 0; i < num_local; ++i) {
+                    for (int l = 0; l < PPRLanes::kWidth; ++l) mine.v[l] += std::abs(next[i].v[l] - values[i].v[l]);
+                }
+                #pragma omp critical
+                reduce(local_change, mine);
+            }
+            MPI_Allreduce(local_change.v, change.v, PPRLanes::kWidth, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            values.swap(next);
+            iter++;
+
+            max_change = *std::max_element(change.v, change.v + PPRLanes::kWidth);
+            if (max_change <= tolerance) break;
+        }
+
+        last_iterations_ = iter;
+        last_change_ = max_change;
+        return values;
+    }
+
+    // Forward push (Andersen, Chung, Lang) for one seed set: every vertex keeps an estimate
+    // and a residual of not yet distributed mass, starting with the seed set's mass as
+    // residual. A vertex whose residual exceeds epsilon * out-degree keeps 1 - damping of it
+    // and pushes the rest evenly to its out-neighbors (dangling vertices push back to the
+    // seeds), all such vertices at once per superstep through the engine's frontier. Work is
+    // proportional to the vertices the mass reaches, not to the graph. On return every
+    // residual is at most epsilon * degree. The estimates of the local vertices stay valid
+    // until the next call; only the vertices in touched() can be non-zero.
+    const std::vector<double>& computePush(const SeedSet& seeds, double damping = 0.85,
+                                           double epsilon = 1e-6, int max_supersteps = 1000) {
+        if (seeds.empty()) throw std::runtime_error("PPR query without seeds");
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const double share = 1.0 / seeds.size();
+
+        if (estimate_.size() != num_local) {
+            estimate_.assign(num_local, 0.0);
+            residual_.assign(num_local, 0.0);
+            touched_.resize(num_local);
+            frontier_.resize(num_local);
+        }
+        // Only the previous query's vertices need resetting
+        touched_.forEach([&](VertexId i) {
+            estimate_[i] = 0.0;
+            residual_[i] = 0.0;
+        });
+        touched_.clear();
+        frontier_.clear();
+
+        auto threshold = [&](VertexId local_id) {
+            return epsilon * std::max<VertexId>(graph_.getOutDegree(local_id), 1);
+        };
+
+        for (VertexId s : seeds) {
+            if (graph_.ownerOf(s) != graph_.getRank()) continue;
+            residual_[s - start_id] += share;
+            touched_.insert(s - start_id);
+        }
+        for (VertexId s : seeds) {
+            if (graph_.ownerOf(s) == graph_.getRank() && residual_[s - start_id] > threshold(s - start_id)) {
+                frontier_.insert(s - start_id);
+            }
+        }
+        frontier_.finalize();
+
+        // Called concurrently for distinct active vertices
+        auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<double>>>& buffers) {
+            double mass = residual_[local_id];
+            residual_[local_id] = 0.0;
+            estimate_[local_id] += (1.0 - damping) * mass;
+
+            VertexId degree = graph_.getOutDegree(local_id);
+            if (degree == 0) {
+                for (VertexId s : seeds) buffers[push_engine_.getOwner(s)].push_back({s, damping * mass * share});
+                return;
+            }
+            double contribution = damping * mass * graph_.inverseOutDegrees()[local_id];
+            for (VertexId global_dst : graph_.neighbors(local_id)) {
+                buffers[push_engine_.getOwner(global_dst)].push_back({global_dst, contribution});
+            }
+        };
+
+        auto sum = makeCombiner<double>(0.0, [](double& acc, const double& val) { acc += val; });
+
+        auto apply = [&](VertexId global_dst, const double& received) {
+            VertexId local_idx = global_dst - start_id;
+            residual_[local_idx] += received;
+            touched_.insert(local_idx);
+            return residual_[local_idx] > threshold(local_idx);
+        };
+
+        int supersteps = 0;
+        while (supersteps < max_supersteps && push_engine_.globalFrontierSize(frontier_) > 0) {
+            push_engine_.runFrontier(frontier_, scatter, sum, apply);
+            supersteps++;
+        }
+        touched_.finalize();
+
+        last_iterations_ = supersteps;
+        return estimate_;
+    }
+
+    // Local vertices the last computePush reached
+    const Frontier& touched() const { return touched_; }
+
+    // Iterations (computeBatch) or supersteps (computePush) of the last query
+    int lastIterations() const { return last_iterations_; }
+    // Largest per-lane L1 change of the last computeBatch iteration
+    double lastChange() const { return last_change_; }
+
+    // Gather every query's k best scores on rank 0 (collective). local[q] holds this rank's
+    // candidates for query q; only their k best are sent. Other ranks get empty lists.
+    std::vector<std::vector<PPRScore>> gatherTop(std::vector<std::vector<PPRScore>>& local, size_t k) const {
+        auto better = [](const PPRScore& a, const PPRScore& b) {
+            return a.score != b.score ? a.score > b.score : a.vertex < b.vertex;
+        };
+        struct Ranked {
+            uint64_t query;
+            PPRScore entry;
+        };
+        std::vector<std::vector<Ranked>> outboxes(graph_.getSize());
+        for (size_t q = 0; q < local.size(); ++q) {
+            size_t keep = std::min(k, local[q].size());
+            std::partial_sort(local[q].begin(), local[q].begin() + keep, local[q].end(), better);
+            for (size_t j = 0; j < keep; ++j) outboxes[0].push_back({q, local[q][j]});
+        }
+        std::vector<Ranked> received;
+        exchangeBuffers(MPI_COMM_WORLD, outboxes, received);
+
+        std::vector<std::vector<PPRScore>> top(graph_.getRank() == 0 ? local.size() : 0);
+        for (const Ranked& r : received) top[r.query].push_back(r.entry);
+        for (auto& list : top) {
+            std::sort(list.begin(), list.end(), better);
+            if (list.size() > k) list.resize(k);
+        }
+        return top;
+    }
+
+private:
+    Graph& graph_;
+    Engine<PPRLanes> batch_engine_;
+    Engine<double> push_engine_;
+
+    // Forward-push state, reused across queries
+    std::vector<double> estimate_;
+    std::vector<double> residual_;
+    Frontier touched_;
+    Frontier frontier_;
+
+    int last_iterations_ = 0;
+    double last_change_ = 0.0;
+};
+
+} // namespace dgraph
@@ -2,138 +2,354 @@
 
 #include "../Graph.hpp"
 #include "../Engine.hpp"
+#include "../Sampling.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 #include <vector>
-#include <random>
-#include <fstream>
-#include <sstream>
 
 namespace dgraph {
 
-struct Walk {
-    uint64_t id;      // Unique walk ID
-    VertexId start_node;
-    std::vector<VertexId> path;
+// A walker in flight. The vertex it stands on is the destination of the message carrying it,
+// so every hop ships one fixed-size (vertex, walk, previous vertex, step) record, however long
+// the walk is.
+struct Walker {
+    uint64_t walk;  // start vertex * walks per vertex + walk index
+    VertexId prev;  // Vertex the last hop came from (node2vec bias)
+    uint32_t step;  // Hops taken so far
 };
 
-// Wrapper for Message Accumulation
-// We receive multiple walks. Engine's reduce needs to merge them.
-// Actually Engine's reduce assumes ONE value per vertex.
-// But here, a vertex might receive multiple walkers from different neighbors.
-// So AccT should be std::vector<Walk>.
-struct WalkList {
-    std::vector<Walk> walks;
+// One vertex of one walk, recorded by the rank that owns the vertex when the walker is there
+struct PathEntry {
+    uint64_t walk;
+    uint64_t step;
+    VertexId vertex;  // Input-file id
+};
+
+// Buffered output for finished walks.
+//   Text:   one walk per line, space-separated vertex ids (what word2vec-style tools read)
+//   Binary: the magic "DGWALKS1", then per walk a uint32 length and that many uint64 ids
+class WalkWriter {
+public:
+    enum class Format { Text, Binary };
+
+    static constexpr char kBinaryMagic[8] = {'D', 'G', 'W', 'A', 'L', 'K', 'S', '1'};
+
+    WalkWriter(const std::string& filename, Format format, size_t buffer_bytes = 1 << 20)
+        : format_(format), buffer_(std::max<size_t>(buffer_bytes, 64)) {
+        file_ = std::fopen(filename.c_str(), "wb");
+        if (!file_) throw std::runtime_error("Could not create walk output: " + filename);
+        if (format_ == Format::Binary) append(kBinaryMagic, sizeof(kBinaryMagic));
+    }
+
+    // Write errors surface from close(); a writer unwound by an exception must not throw again
+    ~WalkWriter() {
+        try {
+            close();
+        } catch (const std::exception&) {
+        }
+    }
+
+    WalkWriter(const WalkWriter&) = delete;
+    WalkWriter& operator=(const WalkWriter&) = delete;
+
+    void write(const VertexId* ids, size_t count) {
+        if (format_ == Format::Binary) {
+            uint32_t length = static_cast<uint32_t>(count);
+            append(&length, sizeof(length));
+            append(ids, count * sizeof(VertexId));
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            // 20 digits and a separator always fit
+            if (buffer_.size() - used_ < 21) flush();
+            char* out = buffer_.data() + used_;
+            out = std::to_chars(out, buffer_.data() + buffer_.size(), ids[i]).ptr;
+            *out++ = (i + 1 == count) ? '\n' : ' ';
+            used_ = out - buffer_.data();
+        }
+    }
+
+    // The file is closed even if the last flush fails; errors from either step are reported
+    void close() {
+        if (!file_) return;
+        bool flushed = true;
+        try {
+            flush();
+        } catch (const std::runtime_error&) {
+            flushed = false;
+        }
+        bool closed = std::fclose(file_) == 0;
+        file_ = nullptr;
+        if (!flushed || !closed) throw std::runtime_error("Failed writing walk output");
+    }
+
+private:
+    void append(const void* data, size_t bytes) {
+        const char* src = static_cast<const char*>(data);
+        while (bytes > 0) {
+            if (used_ == buffer_.size()) flush();
+            size_t n = std::min(bytes, buffer_.size() - used_);
+            std::memcpy(buffer_.data() + used_, src, n);
+            used_ += n;
+            src += n;
+            bytes -= n;
+        }
+    }
+
+    void flush() {
+        if (used_ > 0 && std::fwrite(buffer_.data(), 1, used_, file_) != used_) {
+            throw std::runtime_error("Failed writing walk output");
+        }
+        used_ = 0;
+    }
+
+    Format format_;
+    std::FILE* file_ = nullptr;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
 };
 
 class RandomWalk {
 public:
-    RandomWalk(Graph& graph) : graph_(graph), engine_(graph) {}
-
-    // walk_length: Length of walk
-    // num_walks: Walks per node
-    void compute(int walk_length, int num_walks, const std::string& output_prefix) {
-        VertexId num_local = graph_.numLocalVertices();
-        VertexId start_id = graph_.globalStartId();
-        
-        // Active walks residing at local vertices
-        // Map: Local Vertex Index -> List of walks currently parked there
-        std::vector<std::vector<Walk>> active_walks(num_local);
-        
-        // Initialize walks
-        for(VertexId i=0; i<num_local; ++i) {
-            for(int w=0; w<num_walks; ++w) {
-                Walk walk;
-                walk.id = (uint64_t(start_id + i) << 32) | w; // Simple unique ID
-                walk.start_node = start_id + i;
-                walk.path.push_back(start_id + i);
-                active_walks[i].push_back(walk);
+    RandomWalk(Graph& graph) : graph_(graph), engine_(graph), rng_(kDefaultSeed) {}
+
+    static constexpr uint64_t kDefaultSeed = 0x5EED;
+
+    // Walks draw their random numbers from Philox keyed by this seed
+    void setSeed(uint64_t seed) { rng_ = Philox4x32(seed); }
+
+    // Switch to node2vec second-order walks: after stepping t -> v, the next vertex x is chosen
+    // with probability proportional to weight(v, x) times 1/p if x == t, 1 if x is a neighbor
+    // of t and 1/q otherwise. p = q = 1 gives plain weighted walks.
+    void setNode2Vec(double p, double q) {
+        if (!(p > 0.0) || !(q > 0.0)) throw std::runtime_error("node2vec p and q must be positive");
+        node2vec_ = true;
+        return_bias_ = 1.0 / p;
+        inout_bias_ = 1.0 / q;
+    }
+
+    // walk_length: hops per walk (walks stop early at vertices without out-edges)
+    // num_walks: walks started from every vertex, simulated batch_walks at a time to bound
+    // the memory held by path shards
+    // Writes <output_prefix>_<rank>.txt (or .bin) holding the walks that start on this rank.
+    void compute(int walk_length, int num_walks, const std::string& output_prefix,
+                 WalkWriter::Format format = WalkWriter::Format::Text, int batch_walks = 0) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        if (batch_walks <= 0) batch_walks = num_walks;
+        if (node2vec_ && alias_.empty()) alias_.build(graph_);
+
+        std::string filename = output_prefix + "_" + std::to_string(graph_.getRank()) +
+                               (format == WalkWriter::Format::Binary ? ".bin" : ".txt");
+        WalkWriter writer(filename, format);
+
+        // One path shard per thread, appended to as walkers arrive at local vertices
+        std::vector<std::vector<PathEntry>> shards(omp_get_max_threads());
+
+        for (int first = 0; first < num_walks; first += batch_walks) {
+            const int batch = std::min(batch_walks, num_walks - first);
+
+            // Walkers parked at every local vertex, grouped like the engine's grouped messages
+            walker_offsets_.resize(num_local + 1);
+            walkers_.resize(num_local * batch);
+            #pragma omp parallel for
+            for (VertexId i = 0; i < num_local; ++i) {
+                auto& shard = shards[omp_get_thread_num()];
+                walker_offsets_[i] = i * batch;
+                for (int w = 0; w < batch; ++w) {
+                    uint64_t walk = (start_id + i) * num_walks + first + w;
+                    walkers_[i * batch + w] = {walk, start_id + i, 0};
+                    shard.push_back({walk, 0, graph_.originalId(i)});
+                }
             }
-        }
+            walker_offsets_[num_local] = num_local * batch;
 
-        // Random Number Generator
-        std::mt19937 rng(1234 + graph_.getRank()); 
-
-        // Steps
-        for(int step = 0; step < walk_length; ++step) {
-            
-            auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<Walk>>>& buffers) {
-                // For each walk currently at this node, move it to a neighbor
-                auto& walks = active_walks[local_id];
-                if (walks.empty()) return;
-                
-                auto neighbors = graph_.getNeighbors(local_id);
+            auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<Walker>>>& buffers) {
                 VertexId degree = graph_.getOutDegree(local_id);
-                
-                if (degree == 0) {
-                    // Dead end: Stay here or terminate? 
-                    // Let's just keep them here (they won't move). 
-                    // In BSP scatter, if we don't send, they disappear from "next state" logic if we clear active_walks.
-                    // So we must handle them.
-                    // Actually, if degree 0, we can't send. They just stay.
-                    // But 'active_walks' will be overwritten by 'apply'. 
-                    // So we need to send to SELF? 
-                    // Engine doesn't support self-messages easily without going through network? 
-                    // Actually Engine handles it if getOwner(self) is me.
-                    for (auto& w : walks) {
-                        buffers[engine_.getRank()].push_back({start_id + local_id, w});
+                if (degree == 0) return;
+                for (size_t k = walker_offsets_[local_id]; k < walker_offsets_[local_id + 1]; ++k) {
+                    Walker w = walkers_[k];
+                    VertexId next_hop;
+                    if (node2vec_) {
+                        next_hop = draws_[k].candidate;
+                    } else {
+                        auto r = rng_(w.walk, w.step, 0);
+                        next_hop = graph_.neighborAt(local_id, wide(r[0], r[1]) % degree);
                     }
-                    return;
-                }
-
-                std::uniform_int_distribution<VertexId> dist(0, degree - 1);
-                
-                for (auto& w : walks) {
-                    // Pick random neighbor
-                    VertexId offset = dist(rng);
-                    VertexId next_hop = *(neighbors.first + offset);
-                    
-                    // Update walk
-                    w.path.push_back(next_hop);
-                    
-                    int owner = engine_.getOwner(next_hop);
-                    buffers[owner].push_back({next_hop, w});
+                    buffers[engine_.getOwner(next_hop)].push_back({next_hop, {w.walk, start_id + local_id, w.step + 1}});
                 }
             };
 
-            auto reduce = [&](WalkList& acc, const Walk& val) {
-                acc.walks.push_back(val);
+            auto arrive = [&](VertexId global_dst, const Walker* arrived, size_t count) {
+                auto& shard = shards[omp_get_thread_num()];
+                VertexId original = graph_.originalId(global_dst - start_id);
+                for (size_t k = 0; k < count; ++k) shard.push_back({arrived[k].walk, arrived[k].step, original});
             };
 
-            // Workaround: We can swap to a 'next_active_walks' buffer.
-            
-            std::vector<std::vector<Walk>> next_active_walks(num_local);
-            
-            // Re-bind apply to use next_active_walks
-            auto apply_safe = [&](VertexId global_dst, const WalkList& val) {
-                VertexId local_idx = global_dst - start_id;
-                if (local_idx < num_local) {
-                    next_active_walks[local_idx] = val.walks;
-                }
-            };
+            for (int step = 0; step < walk_length; ++step) {
+                if (node2vec_) chooseBiasedHops();
+                engine_.runGrouped(1, scatter, arrive);
+                // The grouped arrivals are exactly the next step's walkers
+                walker_offsets_.swap(engine_.lastGroupOffsets());
+                walkers_.swap(engine_.lastGroupedValues());
+            }
 
-            engine_.run(1, scatter, reduce, apply_safe);
-            
-            active_walks = std::move(next_active_walks);
+            writeBatch(shards, writer, num_walks);
         }
+        writer.close();
+    }
+
+private:
+    // Progress of one walker's node2vec draw within a step
+    struct BiasedDraw {
+        VertexId candidate;
+        double threshold;  // Accept the candidate if its bias exceeds this
+        uint32_t trial;    // Rejected candidates so far; names the next Philox block
+        uint8_t state;
+    };
+    enum : uint8_t { kSampling, kAwaitingOwner, kChosen };
+
+    // A membership question for the owner of a walker's previous vertex
+    struct NeighborQuery {
+        VertexId prev;
+        VertexId candidate;
+    };
+
+    static uint64_t wide(uint32_t lo, uint32_t hi) { return (static_cast<uint64_t>(hi) << 32) | lo; }
+
+    // node2vec by rejection (as in KnightKing): draw x from v's alias table, i.e. by edge weight,
+    // and keep it with probability bias(x) / max bias. Only candidates whose fate depends on
+    // whether x neighbors the previous vertex t need t's sorted row; when t lives on another
+    // rank, all such questions of a round are batched to the owners and the rejected walkers
+    // draw again. Trials are numbered, so the outcome doesn't depend on rank or thread count.
+    void chooseBiasedHops() {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const double max_bias = std::max({return_bias_, 1.0, inout_bias_});
+        const double sure_bias = std::min(1.0, inout_bias_);  // Bias of any x != t
+        draws_.assign(walkers_.size(), BiasedDraw{0, 0.0, 0, kSampling});
+
+        auto accepts = [&](const BiasedDraw& d, bool neighbor_of_prev) {
+            return d.threshold < (neighbor_of_prev ? 1.0 : inout_bias_);
+        };
+
+        while (true) {
+            // Draw until accepted, or until a candidate needs a remote neighbor check
+            #pragma omp parallel for schedule(dynamic, 256)
+            for (VertexId i = 0; i < num_local; ++i) {
+                const VertexId degree = graph_.getOutDegree(i);
+                const uint64_t row_begin = graph_.getRowPtr()[i];
+                for (size_t k = walker_offsets_[i]; k < walker_offsets_[i + 1]; ++k) {
+                    BiasedDraw& d = draws_[k];
+                    const Walker& w = walkers_[k];
+                    if (degree == 0) d.state = kChosen;
+                    while (d.state == kSampling) {
+                        auto r = rng_(w.walk, w.step, d.trial);
+                        d.candidate = graph_.neighborAt(i, alias_.sample(row_begin, degree, wide(r[0], r[1]),
+                                                                          Philox4x32::unit(r[2])));
+                        d.threshold = Philox4x32::unit(r[3]) * max_bias;
+                        bool accepted;
+                        if (w.step == 0) accepted = true;  // No previous vertex yet
+                        else if (d.candidate == w.prev) accepted = d.threshold < return_bias_;
+                        else if (d.threshold < sure_bias) accepted = true;
+                        else if (d.threshold >= std::max(1.0, inout_bias_)) accepted = false;
+                        else if (graph_.ownerOf(w.prev) != graph_.getRank()) {
+                            d.state = kAwaitingOwner;
+                            break;
+                        } else accepted = accepts(d, graph_.hasEdge(w.prev - start_id, d.candidate));
+
+                        if (accepted) d.state = kChosen;
+                        else d.trial++;
+                    }
+                }
+            }
 
-        // Output to file
-        std::stringstream ss;
-        ss << output_prefix << "_" << graph_.getRank() << ".txt";
-        std::ofstream outfile(ss.str());
-        
-        for (const auto& list : active_walks) {
-            for (const auto& w : list) {
-                for (size_t i = 0; i < w.path.size(); ++i) {
-                    outfile << w.path[i] << (i == w.path.size() - 1 ? "" : " ");
+            std::vector<std::vector<NeighborQuery>> queries(graph_.getSize());
+            std::vector<std::vector<size_t>> waiting(graph_.getSize());
+            for (size_t k = 0; k < draws_.size(); ++k) {
+                if (draws_[k].state != kAwaitingOwner) continue;
+                int owner = graph_.ownerOf(walkers_[k].prev);
+                queries[owner].push_back({walkers_[k].prev, draws_[k].candidate});
+                waiting[owner].push_back(k);
+            }
+            uint64_t local_waiting = 0, global_waiting = 0;
+            for (const auto& w : waiting) local_waiting += w.size();
+            MPI_Allreduce(&local_waiting, &global_waiting, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+            if (global_waiting == 0) break;
+
+            std::vector<NeighborQuery> asked;
+            std::vector<size_t> asked_counts;
+            exchangeBuffers(MPI_COMM_WORLD, queries, asked, &asked_counts);
+            std::vector<std::vector<uint8_t>> answers(graph_.getSize());
+            size_t pos = 0;
+            for (int r = 0; r < graph_.getSize(); ++r) {
+                answers[r].resize(asked_counts[r]);
+                for (size_t j = 0; j < asked_counts[r]; ++j, ++pos) {
+                    answers[r][j] = graph_.hasEdge(asked[pos].prev - start_id, asked[pos].candidate);
+                }
+            }
+            std::vector<uint8_t> replies;
+            exchangeBuffers(MPI_COMM_WORLD, answers, replies);
+
+            // Replies come back grouped by owner, in the order the questions were asked
+            pos = 0;
+            for (const auto& group : waiting) {
+                for (size_t k : group) {
+                    BiasedDraw& d = draws_[k];
+                    if (accepts(d, replies[pos++] != 0)) {
+                        d.state = kChosen;
+                    } else {
+                        d.state = kSampling;
+                        d.trial++;
+                    }
                 }
-                outfile << "\n";
             }
         }
-        outfile.close();
     }
 
-private:
+    // Send every path entry to the rank that started the walk, order by (walk, step) and write
+    void writeBatch(std::vector<std::vector<PathEntry>>& shards, WalkWriter& writer, int num_walks) {
+        const int size = graph_.getSize();
+        std::vector<std::vector<PathEntry>> outboxes(size);
+        for (auto& shard : shards) {
+            for (const PathEntry& e : shard) {
+                outboxes[graph_.ownerOf(e.walk / num_walks)].push_back(e);
+            }
+            std::vector<PathEntry>().swap(shard);
+        }
+
+        std::vector<PathEntry> entries;
+        exchangeBuffers(MPI_COMM_WORLD, outboxes, entries);
+        std::vector<std::vector<PathEntry>>().swap(outboxes);
+
+        std::sort(entries.begin(), entries.end(), [](const PathEntry& a, const PathEntry& b) {
+            return a.walk != b.walk ? a.walk < b.walk : a.step < b.step;
+        });
+
+        std::vector<VertexId> path;
+        for (size_t k = 0; k < entries.size();) {
+            path.clear();
+            uint64_t walk = entries[k].walk;
+            for (; k < entries.size() && entries[k].walk == walk; ++k) path.push_back(entries[k].vertex);
+            writer.write(path.data(), path.size());
+        }
+    }
+
     Graph& graph_;
-    Engine<Walk, WalkList> engine_;
+    Engine<Walker> engine_;
+    Philox4x32 rng_;
+    bool node2vec_ = false;
+    double return_bias_ = 1.0;  // 1/p
+    double inout_bias_ = 1.0;   // 1/q
+    AliasTable alias_;
+    std::vector<size_t> walker_offsets_;
+    std::vector<Walker> walkers_;
+    std::vector<BiasedDraw> draws_;  // Parallel to walkers_ (node2vec only)
 };
 
 } // namespace dgraph
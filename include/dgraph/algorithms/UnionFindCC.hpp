@@ -0,0 +1,380 @@
+#pragma once
+
+#include "../Graph.hpp"
+#include "../Engine.hpp"
+#include "../Exchange.hpp"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace dgraph {
+
+// Connected components without O(diameter) label propagation.
+//
+// 1. Within a rank: lock-free concurrent union-find over edges whose endpoints are
+//    both local, using Afforest's neighbor sampling to skip the largest component.
+// 2. Across ranks: FastSV-style hook-and-compress on the parent array f, where only
+//    cross-rank edges are left to process. Every local vertex starts at its local root.
+//
+// Edges are treated as undirected (weak connectivity). Each vertex ends up labeled
+// with the smallest global id in its component, same as min-label propagation on
+// symmetric graphs.
+class UnionFindCC {
+public:
+    UnionFindCC(Graph& graph) : graph_(graph), engine_(graph) {}
+
+    std::vector<VertexId> compute(int max_rounds = 1000) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const int rank = graph_.getRank();
+        auto t0 = std::chrono::steady_clock::now();
+
+        // Phase 1: union-find on local-local edges, parents are local indices
+        std::vector<VertexId> comp(num_local);
+        localAfforest(comp);
+
+        // Phase 2 state: global parent of every local vertex. Local edges are dropped from
+        // here on; each vertex keeps a virtual edge to its local root (comp) instead, so the
+        // local tree stays tied together once hooking moves its members apart.
+        std::vector<VertexId> f(num_local);
+        #pragma omp parallel for
+        for (VertexId i = 0; i < num_local; ++i) {
+            f[i] = start_id + comp[i];
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        buildCrossEdges();
+        std::vector<VertexId> ghost_f(ghost_ids_.size());
+        std::vector<VertexId> send_f(send_local_ids_.size());
+        std::vector<VertexId> hooked(num_local);
+
+        auto min_parent = makeCombiner<VertexId>(std::numeric_limits<VertexId>::max(),
+                                                 [](VertexId& acc, const VertexId& val) {
+                                                     if (val < acc) acc = val;
+                                                 });
+
+        int round = 0;
+        bool changed = true;
+        while (changed && round < max_rounds) {
+            int local_changed = 0;
+
+            // Refresh the parents of remote endpoints
+            #pragma omp parallel for
+            for (size_t k = 0; k < send_local_ids_.size(); ++k) {
+                send_f[k] = f[send_local_ids_[k]];
+            }
+            exchangeKnownCounts(MPI_COMM_WORLD, send_f.data(), send_counts_, ghost_f.data(), ghost_counts_);
+
+            // Stochastic hooking: the larger parent of every cross edge adopts the smaller one
+            auto scatter = [&](VertexId u, std::vector<std::vector<Message<VertexId>>>& buffers) {
+                const VertexId fu = f[u];
+                auto hook = [&](VertexId fw) {
+                    if (fw < fu) buffers[graph_.ownerOf(fu)].push_back({fu, fw});
+                    else if (fu < fw) buffers[graph_.ownerOf(fw)].push_back({fw, fu});
+                };
+                hook(f[comp[u]]);
+                for (uint64_t e = cross_ptr_[u]; e < cross_ptr_[u + 1]; ++e) {
+                    hook(ghost_f[cross_ghost_[e]]);
+                }
+            };
+            auto apply = [&](VertexId global_dst, const VertexId& val) {
+                VertexId local = global_dst - start_id;
+                if (val < f[local]) {
+                    f[local] = val;
+                    #pragma omp atomic write
+                    local_changed = 1;
+                }
+            };
+            engine_.runCombined(1, scatter, min_parent, apply);
+
+            // Aggressive hooking: every vertex adopts the smallest parent among its edges
+            #pragma omp parallel for schedule(dynamic, 1024)
+            for (VertexId u = 0; u < num_local; ++u) {
+                VertexId best = std::min(f[u], f[comp[u]]);
+                for (uint64_t e = cross_ptr_[u]; e < cross_ptr_[u + 1]; ++e) {
+                    best = std::min(best, ghost_f[cross_ghost_[e]]);
+                }
+                hooked[u] = best;
+                if (best < f[u]) {
+                    #pragma omp atomic write
+                    local_changed = 1;
+                }
+            }
+            f.swap(hooked);
+
+            // Shortcutting: f[u] = f[f[u]]
+            if (shortcut(f)) local_changed = 1;
+
+            int global_changed = 0;
+            MPI_Allreduce(&local_changed, &global_changed, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+            changed = global_changed > 0;
+            round++;
+        }
+
+        auto t2 = std::chrono::steady_clock::now();
+        if (rank == 0) {
+            std::cout << "Union-find CC: local phase " << std::chrono::duration<double>(t1 - t0).count()
+                      << " s, " << round << " cross-rank rounds in "
+                      << std::chrono::duration<double>(t2 - t1).count() << " s" << std::endl;
+        }
+        return f;
+    }
+
+    // Check labels from compute() against a sequential union-find over every edge, run on
+    // rank 0 (collective; gathers the whole graph there, so meant for test-sized inputs).
+    // Returns the number of vertices whose label differs from the smallest global id in their
+    // weak component, on every rank.
+    uint64_t verify(const std::vector<VertexId>& labels) const {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        struct Arc {
+            VertexId src;
+            VertexId dst;
+        };
+        struct Label {
+            VertexId vertex;
+            VertexId label;
+        };
+        std::vector<std::vector<Arc>> arc_outboxes(graph_.getSize());
+        std::vector<std::vector<Label>> label_outboxes(graph_.getSize());
+        for (VertexId i = 0; i < num_local; ++i) {
+            label_outboxes[0].push_back({start_id + i, labels[i]});
+            for (VertexId dst : graph_.neighbors(i)) arc_outboxes[0].push_back({start_id + i, dst});
+        }
+        std::vector<Arc> arcs;
+        std::vector<Label> received;
+        exchangeBuffers(MPI_COMM_WORLD, arc_outboxes, arcs);
+        exchangeBuffers(MPI_COMM_WORLD, label_outboxes, received);
+
+        uint64_t mismatches = 0;
+        if (graph_.getRank() == 0) {
+            // Union by smaller id, so every root is its component's smallest vertex
+            std::vector<VertexId> parent(graph_.numGlobalVertices());
+            for (VertexId v = 0; v < parent.size(); ++v) parent[v] = v;
+            auto find = [&](VertexId v) {
+                while (parent[v] != v) v = parent[v] = parent[parent[v]];
+                return v;
+            };
+            for (const Arc& a : arcs) {
+                VertexId ru = find(a.src), rv = find(a.dst);
+                if (ru < rv) parent[rv] = ru;
+                else if (rv < ru) parent[ru] = rv;
+            }
+            for (const Label& l : received) {
+                if (find(l.vertex) != l.label) mismatches++;
+            }
+        }
+        MPI_Bcast(&mismatches, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        return mismatches;
+    }
+
+private:
+    // Afforest-style link: hook the larger root under the smaller with a CAS
+    static void link(std::vector<VertexId>& comp, VertexId u, VertexId v) {
+        VertexId p1 = __atomic_load_n(&comp[u], __ATOMIC_RELAXED);
+        VertexId p2 = __atomic_load_n(&comp[v], __ATOMIC_RELAXED);
+        while (p1 != p2) {
+            VertexId high = std::max(p1, p2);
+            VertexId low = std::min(p1, p2);
+            VertexId p_high = __atomic_load_n(&comp[high], __ATOMIC_RELAXED);
+            if (p_high == low) break;
+            if (p_high == high) {
+                VertexId expected = high;
+                if (__atomic_compare_exchange_n(&comp[high], &expected, low, false,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            }
+            p1 = __atomic_load_n(&comp[__atomic_load_n(&comp[high], __ATOMIC_RELAXED)], __ATOMIC_RELAXED);
+            p2 = __atomic_load_n(&comp[low], __ATOMIC_RELAXED);
+        }
+    }
+
+    static void compress(std::vector<VertexId>& comp) {
+        #pragma omp parallel for schedule(dynamic, 4096)
+        for (VertexId v = 0; v < comp.size(); ++v) {
+            while (comp[v] != comp[comp[v]]) {
+                comp[v] = comp[comp[v]];
+            }
+        }
+    }
+
+    // Link the k-th local neighbor of every vertex (or all remaining ones if k < 0). Edges
+    // between two members of `skip` (the sampled giant component) are left out: they cannot
+    // join anything new. Both ends are checked because the CSR only holds out-edges.
+    void linkNeighbors(std::vector<VertexId>& comp, int k, int first_rest, VertexId skip) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const VertexId end_id = graph_.globalEndId();
+
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (VertexId u = 0; u < num_local; ++u) {
+            const bool in_skip = skip != kNoSkip && __atomic_load_n(&comp[u], __ATOMIC_RELAXED) == skip;
+            int idx = 0;
+            for (VertexId dst : graph_.neighbors(u)) {
+                bool take = (k >= 0) ? idx == k : idx >= first_rest;
+                if (take && dst >= start_id && dst < end_id) {
+                    VertexId v = dst - start_id;
+                    if (!in_skip || __atomic_load_n(&comp[v], __ATOMIC_RELAXED) != skip) link(comp, u, v);
+                }
+                if (k >= 0 && idx >= k) break;
+                idx++;
+            }
+        }
+    }
+
+    void localAfforest(std::vector<VertexId>& comp) {
+        const VertexId num_local = graph_.numLocalVertices();
+        for (VertexId i = 0; i < num_local; ++i) comp[i] = i;
+        if (num_local == 0) return;
+
+        // A couple of neighbor rounds already join most of a power-law graph
+        const int neighbor_rounds = 2;
+        for (int r = 0; r < neighbor_rounds; ++r) {
+            linkNeighbors(comp, r, 0, kNoSkip);
+            compress(comp);
+        }
+
+        // Sample the most frequent component and skip the remaining edges inside it. Skipped
+        // members still scan their out-edges: the local CSR is directed, so an edge from the
+        // giant component to a vertex outside it is not seen from the other side.
+        std::mt19937_64 rng(42 + graph_.getRank());
+        std::uniform_int_distribution<VertexId> pick(0, num_local - 1);
+        std::vector<VertexId> samples(std::min<VertexId>(1024, num_local));
+        for (auto& s : samples) s = comp[pick(rng)];
+        std::sort(samples.begin(), samples.end());
+        VertexId giant = samples[0];
+        size_t best = 0;
+        for (size_t i = 0; i < samples.size();) {
+            size_t j = i;
+            while (j < samples.size() && samples[j] == samples[i]) ++j;
+            if (j - i > best) {
+                best = j - i;
+                giant = samples[i];
+            }
+            i = j;
+        }
+
+        linkNeighbors(comp, -1, neighbor_rounds, giant);
+        compress(comp);
+    }
+
+    // Cross-rank edges in CSR form over local sources, with remote endpoints as ghost indices
+    void buildCrossEdges() {
+        if (!cross_ptr_.empty()) return;
+        const VertexId num_local = graph_.numLocalVertices();
+        const int rank = graph_.getRank();
+        const int size = graph_.getSize();
+
+        auto ghost_less = [this](VertexId a, VertexId b) {
+            int oa = graph_.ownerOf(a), ob = graph_.ownerOf(b);
+            return oa != ob ? oa < ob : a < b;
+        };
+
+        cross_ptr_.assign(num_local + 1, 0);
+        for (VertexId u = 0; u < num_local; ++u) {
+            for (VertexId dst : graph_.neighbors(u)) {
+                if (graph_.ownerOf(dst) != rank) {
+                    ghost_ids_.push_back(dst);
+                    cross_ptr_[u + 1]++;
+                }
+            }
+        }
+        for (VertexId u = 0; u < num_local; ++u) cross_ptr_[u + 1] += cross_ptr_[u];
+
+        std::vector<VertexId> endpoints(ghost_ids_);
+        std::sort(ghost_ids_.begin(), ghost_ids_.end(), ghost_less);
+        ghost_ids_.erase(std::unique(ghost_ids_.begin(), ghost_ids_.end()), ghost_ids_.end());
+
+        cross_ghost_.resize(endpoints.size());
+        for (size_t e = 0; e < endpoints.size(); ++e) {
+            auto it = std::lower_bound(ghost_ids_.begin(), ghost_ids_.end(), endpoints[e], ghost_less);
+            cross_ghost_[e] = it - ghost_ids_.begin();
+        }
+
+        ghost_counts_.assign(size, 0);
+        std::vector<std::vector<VertexId>> requests(size);
+        for (VertexId g : ghost_ids_) {
+            int owner = graph_.ownerOf(g);
+            ghost_counts_[owner]++;
+            requests[owner].push_back(g);
+        }
+        exchangeBuffers(MPI_COMM_WORLD, requests, send_local_ids_, &send_counts_);
+        for (VertexId& v : send_local_ids_) v -= graph_.globalStartId();
+    }
+
+    // f[u] = f[f[u]] for every local u, fetching remote grandparents. Returns true if anything moved.
+    bool shortcut(std::vector<VertexId>& f) {
+        const VertexId num_local = graph_.numLocalVertices();
+        const VertexId start_id = graph_.globalStartId();
+        const int rank = graph_.getRank();
+        const int size = graph_.getSize();
+
+        // Ask each owner for the parents of our remote parents
+        std::vector<std::vector<VertexId>> requests(size);
+        for (VertexId u = 0; u < num_local; ++u) {
+            int owner = graph_.ownerOf(f[u]);
+            if (owner != rank) requests[owner].push_back(f[u]);
+        }
+        for (auto& req : requests) {
+            std::sort(req.begin(), req.end());
+            req.erase(std::unique(req.begin(), req.end()), req.end());
+        }
+
+        std::vector<VertexId> asked;
+        std::vector<size_t> asked_counts;
+        exchangeBuffers(MPI_COMM_WORLD, requests, asked, &asked_counts);
+
+        std::vector<std::vector<VertexId>> answers(size);
+        size_t pos = 0;
+        for (int r = 0; r < size; ++r) {
+            answers[r].reserve(asked_counts[r]);
+            for (size_t k = 0; k < asked_counts[r]; ++k, ++pos) {
+                answers[r].push_back(f[asked[pos] - start_id]);
+            }
+        }
+        std::vector<VertexId> replies;
+        exchangeBuffers(MPI_COMM_WORLD, answers, replies);
+
+        // Replies come back per owner in the order we asked
+        std::vector<size_t> reply_offset(size, 0);
+        for (int r = 1; r < size; ++r) reply_offset[r] = reply_offset[r - 1] + requests[r - 1].size();
+
+        std::vector<VertexId> next(num_local);
+        int changed = 0;
+        #pragma omp parallel for reduction(|:changed)
+        for (VertexId u = 0; u < num_local; ++u) {
+            VertexId p = f[u];
+            int owner = graph_.ownerOf(p);
+            VertexId gp;
+            if (owner == rank) {
+                gp = f[p - start_id];
+            } else {
+                const auto& req = requests[owner];
+                size_t idx = std::lower_bound(req.begin(), req.end(), p) - req.begin();
+                gp = replies[reply_offset[owner] + idx];
+            }
+            next[u] = gp;
+            if (gp != p) changed = 1;
+        }
+        f.swap(next);
+        return changed != 0;
+    }
+
+    static constexpr VertexId kNoSkip = std::numeric_limits<VertexId>::max();
+
+    Graph& graph_;
+    Engine<VertexId> engine_;
+
+    std::vector<uint64_t> cross_ptr_;
+    std::vector<VertexId> cross_ghost_;
+    std::vector<VertexId> ghost_ids_;
+    std::vector<size_t> ghost_counts_;
+    std::vector<VertexId> send_local_ids_;
+    std::vector<size_t> send_counts_;
+};
+
+} // namespace dgraph
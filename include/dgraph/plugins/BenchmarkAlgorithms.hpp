@@ -0,0 +1,267 @@
+#pragma once
+
+#include "../IAlgorithm.hpp"
+#include "../Engine.hpp"
+#include "../algorithms/PageRank.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace dgraph {
+
+// Micro-benchmark for the engine's callback dispatch: runs PageRank supersteps with the
+// callbacks passed as plain lambdas (inlined into the engine loops) and again wrapped
+// in std::function (one indirect call per vertex/message), and reports the per-edge cost.
+// Usage: prbench [iterations] [--mode=push|pull|both]
+class PageRankBenchmarkPlugin : public IAlgorithm {
+public:
+    std::string name() const override { return "prbench"; }
+
+    void run(Graph& graph, const std::vector<std::string>& args) override {
+        auto positional = positionalArgs(args);
+        int iterations = positional.empty() ? 10 : std::stoi(positional[0]);
+        std::string mode = getOption(args, "mode", "both");
+        if (mode != "push" && mode != "pull" && mode != "both") {
+            throw std::runtime_error("Unknown prbench mode: " + mode);
+        }
+
+        uint64_t local_edges = graph.numLocalEdges();
+        uint64_t global_edges = 0;
+        MPI_Allreduce(&local_edges, &global_edges, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+        if (graph.getRank() == 0) {
+            std::cout << "PageRank dispatch benchmark: " << iterations << " supersteps over "
+                      << global_edges << " edges" << std::endl;
+        }
+        if (mode != "pull") compare(graph, iterations, global_edges, false);
+        if (mode != "push") compare(graph, iterations, global_edges, true);
+    }
+
+private:
+    void compare(Graph& graph, int iterations, uint64_t global_edges, bool pull) {
+        double inlined = measure(graph, iterations, pull, false);
+        double erased = measure(graph, iterations, pull, true);
+        if (graph.getRank() == 0) {
+            double inlined_ns = inlined * 1e9 / (static_cast<double>(global_edges) * iterations);
+            double erased_ns = erased * 1e9 / (static_cast<double>(global_edges) * iterations);
+            std::cout << (pull ? "  pull" : "  push") << ": inlined " << inlined_ns << " ns/edge, std::function "
+                      << erased_ns << " ns/edge (" << erased / inlined << "x)" << std::endl;
+        }
+    }
+
+    // Seconds (slowest rank) for `iterations` PageRank supersteps
+    double measure(Graph& graph, int iterations, bool pull, bool type_erased) {
+        const VertexId num_local = graph.numLocalVertices();
+        const VertexId start_id = graph.globalStartId();
+        Engine<double> engine(graph);
+        std::vector<double> pr(num_local, 1.0), next(num_local, 0.0);
+
+        auto scatter = [&](VertexId local_id, std::vector<std::vector<Message<double>>>& buffers) {
+            VertexId degree = graph.getOutDegree(local_id);
+            if (degree == 0) return;
+            double contribution = pr[local_id] / degree;
+            for (VertexId dst : graph.neighbors(local_id)) {
+                buffers[graph.ownerOf(dst)].push_back({dst, contribution});
+            }
+        };
+        auto value = [&](VertexId local_id) {
+            VertexId degree = graph.getOutDegree(local_id);
+            return degree > 0 ? pr[local_id] / degree : 0.0;
+        };
+        auto reduce = [](double& acc, const double& val) { acc += val; };
+        auto apply = [&](VertexId global_dst, const double& sum) {
+            next[global_dst - start_id] = 0.15 + 0.85 * sum;
+        };
+
+        // Warm up buffers (and the in-edge index for pull) outside the timed region
+        if (pull) engine.runPull(1, value, reduce, apply);
+        else engine.runCombined(1, scatter, makeCombiner<double>(0.0, reduce), apply);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        auto start = std::chrono::steady_clock::now();
+        for (int iter = 0; iter < iterations; ++iter) {
+            if (type_erased) {
+                std::function<void(VertexId, std::vector<std::vector<Message<double>>>&)> scatter_fn = scatter;
+                std::function<double(VertexId)> value_fn = value;
+                std::function<void(double&, const double&)> reduce_fn = reduce;
+                std::function<void(VertexId, const double&)> apply_fn = apply;
+                if (pull) engine.runPull(1, value_fn, reduce_fn, apply_fn);
+                else engine.runCombined(1, scatter_fn, Combiner<double>{0.0, reduce_fn}, apply_fn);
+            } else {
+                if (pull) engine.runPull(1, value, reduce, apply);
+                else engine.runCombined(1, scatter, makeCombiner<double>(0.0, reduce), apply);
+            }
+            pr.swap(next);
+        }
+        double local = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double slowest = 0.0;
+        MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        return slowest;
+    }
+};
+REGISTER_ALGORITHM(PageRankBenchmarkPlugin);
+
+// Locality benchmark for the vertex orderings: relabels the graph with each ordering in turn
+// and reports the average neighbor id gap next to the PageRank time per iteration.
+// Usage: orderbench [iterations] [--mode=push|pull] [--orders=original,degree,rcm,gorder]
+// The graph stays in the last ordering afterwards.
+class OrderingBenchmarkPlugin : public IAlgorithm {
+public:
+    std::string name() const override { return "orderbench"; }
+
+    void run(Graph& graph, const std::vector<std::string>& args) override {
+        auto positional = positionalArgs(args);
+        int iterations = positional.empty() ? 10 : std::stoi(positional[0]);
+        std::string mode_name = getOption(args, "mode", "pull");
+        PageRank::Mode mode = PageRank::Mode::Pull;
+        if (mode_name == "push") mode = PageRank::Mode::Push;
+        else if (mode_name != "pull") throw std::runtime_error("Unknown orderbench mode: " + mode_name);
+
+        std::vector<VertexOrdering> orderings;
+        std::stringstream list(getOption(args, "orders", "original,degree,rcm,gorder"));
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            VertexOrdering ordering;
+            if (!parseVertexOrdering(item, ordering)) throw std::runtime_error("Unknown vertex ordering: " + item);
+            orderings.push_back(ordering);
+        }
+
+        struct Result {
+            VertexOrdering ordering;
+            double gap;
+            double seconds_per_iteration;
+        };
+        std::vector<Result> results;
+        for (VertexOrdering ordering : orderings) {
+            graph.reorder(ordering);
+            double gap = graph.averageNeighborGap();
+
+            PageRank pr(graph);
+            MPI_Barrier(MPI_COMM_WORLD);
+            auto start = std::chrono::steady_clock::now();
+            pr.compute(iterations, 0.85, mode);
+            double local = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double slowest = 0.0;
+            MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            results.push_back({ordering, gap, slowest / iterations});
+        }
+
+        if (graph.getRank() == 0) {
+            std::cout << "Ordering     neighbor gap   PageRank s/iteration (" << mode_name << ")" << std::endl;
+            for (const Result& r : results) {
+                std::cout << std::left << std::setw(13) << vertexOrderingName(r.ordering) << std::setw(15) << r.gap
+                          << r.seconds_per_iteration << std::endl;
+            }
+        }
+    }
+};
+REGISTER_ALGORITHM(OrderingBenchmarkPlugin);
+
+// Throughput of the pull-mode gather kernels: runs gatherSum over the in-edge index with
+// every kernel this CPU supports in double and float precision, nothing else in the timed
+// loop, and reports GTEPS (edges gathered per second, slowest rank) next to the largest
+// relative deviation from the scalar double sums and the kernel Auto measures to.
+// Usage: spmvbench [iterations]
+class SpmvBenchmarkPlugin : public IAlgorithm {
+public:
+    std::string name() const override { return "spmvbench"; }
+
+    void run(Graph& graph, const std::vector<std::string>& args) override {
+        auto positional = positionalArgs(args);
+        int iterations = positional.empty() ? 20 : std::stoi(positional[0]);
+
+        if (!graph.hasInEdges()) graph.buildInEdges();
+        const InEdgeIndex& in = graph.getInEdges();
+        const VertexId num_local = graph.numLocalVertices();
+        const VertexId num_slots = num_local + in.numGhosts();
+        if (num_slots > static_cast<uint64_t>(INT32_MAX)) {
+            throw std::runtime_error("spmvbench: the SIMD kernels need fewer than 2^31 slots per rank");
+        }
+
+        uint64_t local_edges = in.sources.size();
+        uint64_t global_edges = 0;
+        MPI_Allreduce(&local_edges, &global_edges, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+        std::vector<SpmvKernel> kernels;
+        for (SpmvKernel kernel : {SpmvKernel::Scalar, SpmvKernel::AVX2, SpmvKernel::AVX512}) {
+            if (spmvKernelSupported(kernel)) kernels.push_back(kernel);
+        }
+
+        // Rank-like values (the sum over all slots is about one) without a skewed distribution
+        std::vector<double> values(num_slots);
+        for (VertexId s = 0; s < num_slots; ++s) values[s] = (1.0 + (s % 7)) / (4.0 * num_slots);
+        std::vector<float> float_values(values.begin(), values.end());
+
+        struct Result {
+            SpmvKernel kernel;
+            const char* precision;
+            double gteps;
+            double max_diff;
+        };
+        std::vector<Result> results;
+        std::vector<double> reference;
+
+        auto measure = [&](auto* vals, auto& sums, SpmvKernel kernel) {
+            const VertexId kRowBlock = 1024;
+            auto pass = [&]() {
+                #pragma omp parallel for schedule(dynamic, 1)
+                for (VertexId begin = 0; begin < num_local; begin += kRowBlock) {
+                    gatherSum(kernel, in.row_ptr.data(), in.sources.data(), vals, sums.data(), begin,
+                              std::min(begin + kRowBlock, num_local));
+                }
+            };
+            pass(); // Warm-up: page in the index and values
+
+            MPI_Barrier(MPI_COMM_WORLD);
+            auto start = std::chrono::steady_clock::now();
+            for (int iter = 0; iter < iterations; ++iter) pass();
+            double local = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double slowest = 0.0;
+            MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+            if (reference.empty()) reference.assign(sums.begin(), sums.end());
+            double local_diff = 0.0, diff = 0.0;
+            for (VertexId i = 0; i < num_local; ++i) {
+                if (reference[i] != 0.0) local_diff = std::max(local_diff, std::abs(sums[i] - reference[i]) / reference[i]);
+            }
+            MPI_Allreduce(&local_diff, &diff, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            return std::make_pair(static_cast<double>(global_edges) * iterations / slowest / 1e9, diff);
+        };
+
+        std::vector<double> sums(num_local);
+        for (SpmvKernel kernel : kernels) {
+            auto [gteps, diff] = measure(values.data(), sums, kernel);
+            results.push_back({kernel, "double", gteps, diff});
+        }
+        SpmvKernel auto_double = fastestSpmvKernel(in.row_ptr.data(), in.sources.data(), values.data(), sums.data(), num_local);
+
+        std::vector<float> float_sums(num_local);
+        for (SpmvKernel kernel : kernels) {
+            auto [gteps, diff] = measure(float_values.data(), float_sums, kernel);
+            results.push_back({kernel, "float", gteps, diff});
+        }
+        SpmvKernel auto_float = fastestSpmvKernel(in.row_ptr.data(), in.sources.data(), float_values.data(),
+                                                  float_sums.data(), num_local);
+
+        if (graph.getRank() == 0) {
+            std::cout << "SpMV benchmark: " << iterations << " gathers over " << global_edges << " in-edges ("
+                      << static_cast<double>(global_edges) / std::max<VertexId>(1, graph.numGlobalVertices())
+                      << " per vertex)" << std::endl;
+            std::cout << "Kernel   Precision  GTEPS      max rel |diff| vs scalar double" << std::endl;
+            for (const Result& r : results) {
+                std::cout << std::left << std::setw(9) << spmvKernelName(r.kernel) << std::setw(11) << r.precision
+                          << std::setw(11) << r.gteps << r.max_diff << std::endl;
+            }
+            std::cout << "Auto on rank 0: " << spmvKernelName(auto_double) << " (double), "
+                      << spmvKernelName(auto_float) << " (float)" << std::endl;
+        }
+    }
+};
+REGISTER_ALGORITHM(SpmvBenchmarkPlugin);
+
+} // namespace dgraph
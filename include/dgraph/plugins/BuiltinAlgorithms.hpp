@@ -3,11 +3,18 @@
 #include "../IAlgorithm.hpp"
 #include "../algorithms/BFS.hpp"
 #include "../algorithms/ConnectedComponents.hpp"
+#include "../algorithms/UnionFindCC.hpp"
 #include "../algorithms/PageRank.hpp"
 #include "../algorithms/LabelPropagation.hpp"
 #include "../algorithms/RandomWalk.hpp"
+#include "../algorithms/PersonalizedPageRank.hpp"
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <stdexcept>
 
 namespace dgraph {
 
@@ -15,20 +22,31 @@ class BFSPlugin : public IAlgorithm {
 public:
     std::string name() const override { return "bfs"; }
     void run(Graph& graph, const std::vector<std::string>& args) override {
+        auto positional = positionalArgs(args);
         VertexId source = 0;
-        if (!args.empty()) source = std::stoull(args[0]);
+        if (!positional.empty()) source = std::stoull(positional[0]);
         
         int rank = graph.getRank();
         if (rank == 0) std::cout << "Running BFS from source " << source << "..." << std::endl;
+        // The source is given as an input-file id
+        source = graph.internalId(source);
         
+        // Usage: bfs [source] [--direction=topdown|auto] [--combine] [--async]
+        std::string direction_name = getOption(args, "direction", "topdown");
+        BFS::Direction direction = BFS::Direction::TopDown;
+        if (direction_name == "auto") direction = BFS::Direction::Auto;
+        else if (direction_name != "topdown") throw std::runtime_error("Unknown BFS direction: " + direction_name);
+
         BFS bfs(graph);
-        auto results = bfs.compute(source);
+        bfs.setSenderCombining(getOption(args, "combine") == "true");
+        bfs.setAsyncExchange(getOption(args, "async") == "true");
+        auto results = bfs.compute(source, 100, direction);
         
         // Output logic (Distributed print)
         for (int r = 0; r < graph.getSize(); ++r) {
             if (rank == r) {
                 for (VertexId i = 0; i < graph.numLocalVertices(); ++i) {
-                    VertexId global_id = graph.globalStartId() + i;
+                    VertexId global_id = graph.originalId(i);
                     std::cout << "V[" << global_id << "]: BFS_Dist=";
                     if (results[i] == std::numeric_limits<uint64_t>::max()) 
                         std::cout << "INF";
@@ -47,17 +65,42 @@ class CCPlugin : public IAlgorithm {
 public:
     std::string name() const override { return "cc"; }
     void run(Graph& graph, const std::vector<std::string>& args) override {
-        (void)args; // Unused
         int rank = graph.getRank();
         if (rank == 0) std::cout << "Running Connected Components..." << std::endl;
         
-        ConnectedComponents cc(graph);
-        auto results = cc.compute();
+        // Usage: cc [--algo=labelprop|unionfind] [--mode=push|grid] [--combine] [--async] [--verify]
+        // --verify checks union-find labels against a sequential union-find on rank 0.
+        std::string algo = getOption(args, "algo", "labelprop");
+        std::string mode_name = getOption(args, "mode", "push");
+        ConnectedComponents::Mode mode = ConnectedComponents::Mode::Push;
+        if (mode_name == "grid") mode = ConnectedComponents::Mode::Grid;
+        else if (mode_name != "push") throw std::runtime_error("Unknown CC mode: " + mode_name);
+        std::vector<VertexId> results;
+        if (algo == "unionfind") {
+            UnionFindCC cc(graph);
+            results = cc.compute();
+            if (getOption(args, "verify") == "true") {
+                uint64_t mismatches = cc.verify(results);
+                if (rank == 0) {
+                    std::cout << "Verification " << (mismatches == 0 ? "passed" : "FAILED") << ": " << mismatches
+                              << " mismatched labels" << std::endl;
+                }
+            }
+            // Union-find labels are parent pointers, i.e. global ids
+            graph.toOriginalIds(results);
+        } else if (algo == "labelprop") {
+            ConnectedComponents cc(graph);
+            cc.setSenderCombining(getOption(args, "combine") == "true");
+            cc.setAsyncExchange(getOption(args, "async") == "true");
+            results = cc.compute(100, mode);
+        } else {
+            throw std::runtime_error("Unknown CC algorithm: " + algo);
+        }
         
         for (int r = 0; r < graph.getSize(); ++r) {
             if (rank == r) {
                 for (VertexId i = 0; i < graph.numLocalVertices(); ++i) {
-                    VertexId global_id = graph.globalStartId() + i;
+                    VertexId global_id = graph.originalId(i);
                     std::cout << "V[" << global_id << "]: CC_ID=" << results[i] << std::endl;
                 }
             }
@@ -71,17 +114,48 @@ class PageRankPlugin : public IAlgorithm {
 public:
     std::string name() const override { return "pr"; }
     void run(Graph& graph, const std::vector<std::string>& args) override {
-        (void)args;
+        // Usage: pr [iterations] [--mode=push|pull|grid|delta] [--tol=<L1>] [--combine] [--async]
+        //           [--kernel=auto|scalar|avx2|avx512] [--precision=double|float]
+        // With --mode=delta, iterations is an upper bound (default 100) and --tol the
+        // residual L1 tolerance relative to the total rank mass (default 1e-4). --kernel and
+        // --precision select the gather kernel and value type of --mode=pull (other modes
+        // reject them).
+        auto positional = positionalArgs(args);
+        std::string mode_name = getOption(args, "mode", "push");
+        int iterations = positional.empty() ? (mode_name == "delta" ? 100 : 10) : std::stoi(positional[0]);
+        PageRank::Mode mode = PageRank::Mode::Push;
+        if (mode_name == "pull") mode = PageRank::Mode::Pull;
+        else if (mode_name == "grid") mode = PageRank::Mode::Grid;
+        else if (mode_name != "push" && mode_name != "delta") throw std::runtime_error("Unknown PageRank mode: " + mode_name);
+        SpmvKernel kernel = SpmvKernel::Auto;
+        std::string kernel_name = getOption(args, "kernel", "auto");
+        if (!parseSpmvKernel(kernel_name, kernel)) throw std::runtime_error("Unknown SpMV kernel: " + kernel_name);
+        std::string precision_name = getOption(args, "precision", "double");
+        PageRank::Precision precision = PageRank::Precision::Double;
+        if (precision_name == "float") precision = PageRank::Precision::Float;
+        else if (precision_name != "double") throw std::runtime_error("Unknown PageRank precision: " + precision_name);
+        if (mode != PageRank::Mode::Pull && (!getOption(args, "kernel").empty() || !getOption(args, "precision").empty())) {
+            throw std::runtime_error("--kernel and --precision only apply to --mode=pull");
+        }
+
         int rank = graph.getRank();
-        if (rank == 0) std::cout << "Running PageRank..." << std::endl;
+        if (rank == 0) std::cout << "Running PageRank (" << mode_name << ")..." << std::endl;
         
         PageRank pr(graph);
-        auto results = pr.compute();
+        pr.setSenderCombining(getOption(args, "combine") == "true");
+        pr.setAsyncExchange(getOption(args, "async") == "true");
+        pr.setPullKernel(kernel);
+        pr.setPrecision(precision);
+        if (rank == 0 && mode == PageRank::Mode::Pull) {
+            std::cout << "Pull kernel: " << spmvKernelName(resolveSpmvKernel(kernel)) << ", " << precision_name << std::endl;
+        }
+        auto results = mode_name == "delta" ? pr.computeDelta(iterations, 0.85, std::stod(getOption(args, "tol", "1e-4")))
+                                            : pr.compute(iterations, 0.85, mode);
         
         for (int r = 0; r < graph.getSize(); ++r) {
             if (rank == r) {
                 for (VertexId i = 0; i < graph.numLocalVertices(); ++i) {
-                    VertexId global_id = graph.globalStartId() + i;
+                    VertexId global_id = graph.originalId(i);
                     std::cout << "V[" << global_id << "]: PR=" << std::fixed << std::setprecision(4) << results[i] << std::endl;
                 }
             }
@@ -95,17 +169,22 @@ class LPAPlugin : public IAlgorithm {
 public:
     std::string name() const override { return "lpa"; }
     void run(Graph& graph, const std::vector<std::string>& args) override {
-        (void)args;
         int rank = graph.getRank();
         if (rank == 0) std::cout << "Running Label Propagation..." << std::endl;
-        
+
+        // Usage: lpa [--ties=smallest|random]
+        std::string ties_name = getOption(args, "ties", "smallest");
+        LabelPropagation::TieBreak ties = LabelPropagation::TieBreak::Smallest;
+        if (ties_name == "random") ties = LabelPropagation::TieBreak::Random;
+        else if (ties_name != "smallest") throw std::runtime_error("Unknown LPA tie-breaking: " + ties_name);
+
         LabelPropagation lpa(graph);
-        auto results = lpa.compute();
+        auto results = lpa.compute(10, ties);
         
         for (int r = 0; r < graph.getSize(); ++r) {
             if (rank == r) {
                 for (VertexId i = 0; i < graph.numLocalVertices(); ++i) {
-                    VertexId global_id = graph.globalStartId() + i;
+                    VertexId global_id = graph.originalId(i);
                     std::cout << "V[" << global_id << "]: Community=" << results[i] << std::endl;
                 }
             }
@@ -119,20 +198,146 @@ class RWPlugin : public IAlgorithm {
 public:
     std::string name() const override { return "rw"; }
     void run(Graph& graph, const std::vector<std::string>& args) override {
+        auto positional = positionalArgs(args);
         int walk_len = 10;
         int num_walks = 5;
-        if (args.size() >= 1) walk_len = std::stoi(args[0]);
-        if (args.size() >= 2) num_walks = std::stoi(args[1]);
+        if (positional.size() >= 1) walk_len = std::stoi(positional[0]);
+        if (positional.size() >= 2) num_walks = std::stoi(positional[1]);
         
+        // Usage: rw [length] [walks] [--format=text|binary] [--batch=<walks>] [--out=<prefix>]
+        //           [--mode=uniform|node2vec] [--p=<return>] [--q=<in-out>] [--seed=<n>]
+        std::string format_name = getOption(args, "format", "text");
+        WalkWriter::Format format = WalkWriter::Format::Text;
+        if (format_name == "binary") format = WalkWriter::Format::Binary;
+        else if (format_name != "text") throw std::runtime_error("Unknown walk output format: " + format_name);
+        int batch = std::stoi(getOption(args, "batch", "0"));
+        std::string prefix = getOption(args, "out", "walks_out");
+        std::string mode = getOption(args, "mode", "uniform");
+        if (mode != "uniform" && mode != "node2vec") throw std::runtime_error("Unknown walk mode: " + mode);
+        double p = std::stod(getOption(args, "p", "1"));
+        double q = std::stod(getOption(args, "q", "1"));
+
         int rank = graph.getRank();
-        if (rank == 0) std::cout << "Running Random Walk (L=" << walk_len << ", N=" << num_walks << ")..." << std::endl;
+        if (rank == 0) {
+            std::cout << "Running Random Walk (L=" << walk_len << ", N=" << num_walks;
+            if (mode == "node2vec") std::cout << ", node2vec p=" << p << " q=" << q;
+            std::cout << ")..." << std::endl;
+        }
         
         RandomWalk rw(graph);
-        rw.compute(walk_len, num_walks, "walks_out");
+        rw.setSeed(std::stoull(getOption(args, "seed", std::to_string(RandomWalk::kDefaultSeed))));
+        if (mode == "node2vec") rw.setNode2Vec(p, q);
+        rw.compute(walk_len, num_walks, prefix, format, batch);
         
-        if (rank == 0) std::cout << "Random Walks written to walks_out_*.txt" << std::endl;
+        if (rank == 0) {
+            std::cout << "Random Walks written to " << prefix << "_*" << (format == WalkWriter::Format::Binary ? ".bin" : ".txt")
+                      << std::endl;
+        }
     }
 };
 REGISTER_ALGORITHM(RWPlugin);
 
+class PPRPlugin : public IAlgorithm {
+public:
+    std::string name() const override { return "ppr"; }
+    void run(Graph& graph, const std::vector<std::string>& args) override {
+        // Usage: ppr <seed_file> [iterations] [--mode=batch|push] [--top=10] [--tol=1e-6] [--eps=1e-6]
+        // The seed file holds one query per line: whitespace-separated input-file vertex ids
+        // that walks restart from ('#' starts a comment line).
+        // batch: power iteration, PPRLanes::kWidth queries per pass (iterations caps each pass)
+        // push:  approximate forward push, one query at a time, until residual <= eps * degree
+        auto positional = positionalArgs(args);
+        if (positional.empty()) throw std::runtime_error("Usage: ppr <seed_file> [iterations] [--mode=batch|push]");
+        int iterations = positional.size() >= 2 ? std::stoi(positional[1]) : 50;
+        std::string mode = getOption(args, "mode", "batch");
+        if (mode != "batch" && mode != "push") throw std::runtime_error("Unknown PPR mode: " + mode);
+        size_t top_k = std::stoul(getOption(args, "top", "10"));
+        double tolerance = std::stod(getOption(args, "tol", "1e-6"));
+        double epsilon = std::stod(getOption(args, "eps", "1e-6"));
+
+        // Every rank reads the (small) seed file and translates all ids in one collective
+        std::ifstream in(positional[0]);
+        if (!in) throw std::runtime_error("Could not open seed file: " + positional[0]);
+        std::vector<SeedSet> queries;
+        std::vector<VertexId> flat;
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(in, line)) {
+            ++line_number;
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            SeedSet seeds;
+            std::string token;
+            while (fields >> token) {
+                // Whole token, digits only: operator>> would stop at junk and wrap "-3"
+                VertexId id;
+                auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), id);
+                if (ec != std::errc() || end != token.data() + token.size()) {
+                    throw std::runtime_error("Bad seed on line " + std::to_string(line_number) + ": " + token);
+                }
+                seeds.push_back(id);
+            }
+            if (seeds.empty()) continue;
+            flat.insert(flat.end(), seeds.begin(), seeds.end());
+            queries.push_back(std::move(seeds));
+        }
+        std::vector<SeedSet> original_queries = queries;
+        graph.toInternalIds(flat);
+        size_t pos = 0;
+        for (auto& seeds : queries) {
+            for (VertexId& s : seeds) {
+                if (flat[pos] >= graph.numGlobalVertices()) throw std::runtime_error("Seed " + std::to_string(s) + " is not a vertex");
+                s = flat[pos++];
+            }
+        }
+
+        int rank = graph.getRank();
+        if (rank == 0) std::cout << "Running Personalized PageRank (" << mode << ", " << queries.size() << " queries)..." << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+        PersonalizedPageRank ppr(graph);
+        const VertexId num_local = graph.numLocalVertices();
+        for (size_t first = 0; first < queries.size();) {
+            size_t count = mode == "batch" ? std::min<size_t>(PPRLanes::kWidth, queries.size() - first) : 1;
+            std::vector<std::vector<PPRScore>> local(count);
+            if (mode == "batch") {
+                std::vector<SeedSet> batch(queries.begin() + first, queries.begin() + first + count);
+                std::vector<PPRLanes> values = ppr.computeBatch(batch, iterations, 0.85, tolerance);
+                for (size_t q = 0; q < count; ++q) {
+                    local[q].reserve(num_local);
+                    for (VertexId i = 0; i < num_local; ++i) local[q].push_back({graph.originalId(i), values[i].v[q]});
+                }
+            } else {
+                const std::vector<double>& estimate = ppr.computePush(queries[first], 0.85, epsilon);
+                ppr.touched().forEach([&](VertexId i) {
+                    if (estimate[i] > 0.0) local[0].push_back({graph.originalId(i), estimate[i]});
+                });
+            }
+            auto top = ppr.gatherTop(local, top_k);
+
+            if (rank == 0) {
+                for (size_t q = 0; q < count; ++q) {
+                    std::cout << "Query " << first + q << " (seeds";
+                    for (VertexId s : original_queries[first + q]) std::cout << " " << s;
+                    std::cout << "), " << ppr.lastIterations() << (mode == "batch" ? " iterations" : " supersteps") << ":" << std::endl;
+                    for (const PPRScore& e : top[q]) {
+                        std::cout << "  V[" << e.vertex << "]: PPR=" << std::fixed << std::setprecision(6) << e.score
+                                  << std::defaultfloat << std::endl;
+                    }
+                }
+            }
+            first += count;
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double slowest = 0.0;
+        MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        if (rank == 0) {
+            std::cout << "PPR answered " << queries.size() << " queries in " << slowest << " s ("
+                      << queries.size() / std::max(slowest, 1e-9) << " queries/s)" << std::endl;
+        }
+    }
+};
+REGISTER_ALGORITHM(PPRPlugin);
+
 } // namespace dgraph
@@ -1,27 +1,357 @@
 #pragma once
 
+// In-process MPI simulator for builds without MPI.
+//
+// mock_mpi::launch runs N logical ranks as threads of one process. Every rank sees
+// MPI_COMM_WORLD of size N. Collectives have real semantics (all ranks rendezvous),
+// point-to-point messages go through per-rank mailboxes, and every rank counts the
+// bytes and messages it sends. An optional latency/bandwidth model delays message
+// delivery and collective completion, so scaling experiments can run on one box.
+// With a single rank it behaves like a plain size-1 mock.
+//
+// Environment:
+//   DGRAPH_SIM_RANKS           number of ranks (default 1)
+//   DGRAPH_SIM_LATENCY_US      per-message latency in microseconds (default 0)
+//   DGRAPH_SIM_BANDWIDTH_MBPS  per-rank link bandwidth in MB/s (default 0 = unlimited)
+//
+// MPI calls are only valid on a rank's own thread (the master thread of its OpenMP
+// teams), which is what MPI_THREAD_FUNNELED promises anyway.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
-// Mock MPI for single-node testing
 typedef int MPI_Comm;
 typedef int MPI_Datatype;
 typedef int MPI_Op;
+typedef int MPI_Request;
 
 #define MPI_COMM_WORLD 0
 #define MPI_INT 0
 #define MPI_DOUBLE 1
 #define MPI_BYTE 2
 #define MPI_UINT64_T 3
+#define MPI_CHAR 4
+#define MPI_FLOAT 5
 
 #define MPI_SUM 0
 #define MPI_MAX 1
+#define MPI_MIN 2
 
 #define MPI_THREAD_FUNNELED 1
 
+#define MPI_ANY_SOURCE -1
+#define MPI_ANY_TAG -1
+#define MPI_UNDEFINED -32766
+#define MPI_COMM_NULL MPI_UNDEFINED
+#define MPI_REQUEST_NULL -1
+
+struct MPI_Status {
+    int MPI_SOURCE;
+    int MPI_TAG;
+    int MPI_ERROR;
+    size_t mock_bytes;
+};
+#define MPI_STATUS_IGNORE (static_cast<MPI_Status*>(nullptr))
+
+namespace mock_mpi {
+
+using Clock = std::chrono::steady_clock;
+
+inline size_t typeSize(MPI_Datatype datatype) {
+    switch (datatype) {
+        case MPI_INT: return sizeof(int);
+        case MPI_DOUBLE: return sizeof(double);
+        case MPI_UINT64_T: return sizeof(uint64_t);
+        case MPI_FLOAT: return sizeof(float);
+        default: return 1; // MPI_BYTE, MPI_CHAR
+    }
+}
+
+// Traffic sent by one rank (point-to-point plus its share of collectives)
+struct Traffic {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> messages{0};
+};
+
+// Reusable generation barrier
+class Barrier {
+public:
+    explicit Barrier(int count) : count_(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t generation = generation_;
+        if (++arrived_ == count_) {
+            arrived_ = 0;
+            generation_++;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [&] { return generation_ != generation; });
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int count_;
+    int arrived_ = 0;
+    uint64_t generation_ = 0;
+};
+
+// A communicator: its members (comm rank -> world rank) and rendezvous slots for collectives
+struct Comm {
+    std::vector<int> members;
+    std::vector<int> rank_of; // world rank -> comm rank, -1 if not a member
+    Barrier barrier;
+    std::vector<const void*> slots;
+    std::vector<double> costs;
+
+    Comm(std::vector<int> member_ranks, int world_size)
+        : members(std::move(member_ranks)), rank_of(world_size, -1),
+          barrier(static_cast<int>(members.size())), slots(members.size()), costs(members.size()) {
+        for (size_t i = 0; i < members.size(); ++i) rank_of[members[i]] = static_cast<int>(i);
+    }
+};
+
+struct Envelope {
+    MPI_Comm comm;
+    int source; // Comm rank of the sender
+    int tag;
+    std::vector<char> bytes;
+    Clock::time_point ready;
+};
+
+struct Mailbox {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Envelope> queue;
+    std::vector<Clock::time_point> last_ready; // Per sender, keeps delivery non-overtaking
+};
+
+struct PendingRecv {
+    void* buf;
+    size_t capacity;
+    int source;
+    int tag;
+    MPI_Comm comm;
+    bool active;
+};
+
+class World {
+public:
+    static World& instance() {
+        static World world;
+        return world;
+    }
+
+    // Reset for a run with `size` ranks; must be called before any rank starts
+    void init(int size, double latency_us, double bandwidth_mbps) {
+        size_ = size;
+        latency_ = latency_us * 1e-6;
+        bandwidth_ = bandwidth_mbps * 1e6;
+        comms_.clear();
+        std::vector<int> all(size);
+        for (int i = 0; i < size; ++i) all[i] = i;
+        comms_.push_back(std::make_unique<Comm>(all, size));
+        mailboxes_.clear();
+        traffic_.clear();
+        for (int i = 0; i < size; ++i) {
+            mailboxes_.push_back(std::make_unique<Mailbox>());
+            mailboxes_.back()->last_ready.assign(size, Clock::time_point());
+            traffic_.push_back(std::make_unique<Traffic>());
+        }
+    }
+
+    int size() const { return size_; }
+
+    Comm& comm(MPI_Comm id) {
+        std::lock_guard<std::mutex> lock(comms_mutex_);
+        return *comms_[id];
+    }
+
+    MPI_Comm addComm(std::vector<int> members) {
+        std::lock_guard<std::mutex> lock(comms_mutex_);
+        comms_.push_back(std::make_unique<Comm>(std::move(members), size_));
+        return static_cast<MPI_Comm>(comms_.size() - 1);
+    }
+
+    Mailbox& mailbox(int world_rank) { return *mailboxes_[world_rank]; }
+    Traffic& traffic(int world_rank) { return *traffic_[world_rank]; }
+
+    // Modelled time to move `bytes` in `messages` messages
+    double cost(uint64_t bytes, uint64_t messages) const {
+        double seconds = latency_ * messages;
+        if (bandwidth_ > 0) seconds += bytes / bandwidth_;
+        return seconds;
+    }
+
+    bool modelled() const { return latency_ > 0 || bandwidth_ > 0; }
+
+private:
+    int size_ = 1;
+    double latency_ = 0;
+    double bandwidth_ = 0;
+    std::mutex comms_mutex_;
+    std::vector<std::unique_ptr<Comm>> comms_;
+    std::vector<std::unique_ptr<Mailbox>> mailboxes_;
+    std::vector<std::unique_ptr<Traffic>> traffic_;
+};
+
+// World rank of the calling thread, and its outstanding receive requests
+inline thread_local int t_rank = 0;
+inline thread_local std::vector<PendingRecv> t_pending;
+
+inline void account(uint64_t bytes, uint64_t messages) {
+    Traffic& traffic = World::instance().traffic(t_rank);
+    traffic.bytes += bytes;
+    traffic.messages += messages;
+}
+
+// Run one collective: publish this rank's contribution, let `body` read everyone's once
+// all have published, and leave only when every rank is done reading. Completion is
+// delayed by the slowest rank's modelled cost.
+template <typename Fn>
+void collective(MPI_Comm id, const void* mine, uint64_t bytes_out, uint64_t messages_out, Fn&& body) {
+    World& world = World::instance();
+    Comm& comm = world.comm(id);
+    const int me = comm.rank_of[t_rank];
+    comm.slots[me] = mine;
+    comm.costs[me] = world.cost(bytes_out, messages_out);
+    account(bytes_out, messages_out);
+
+    comm.barrier.wait();
+    double slowest = *std::max_element(comm.costs.begin(), comm.costs.end());
+    body(comm, me);
+    comm.barrier.wait();
+
+    if (slowest > 0) std::this_thread::sleep_for(std::chrono::duration<double>(slowest));
+}
+
+template <typename T>
+void reduceInto(T* acc, const T* value, int count, MPI_Op op) {
+    for (int i = 0; i < count; ++i) {
+        switch (op) {
+            case MPI_SUM: acc[i] += value[i]; break;
+            case MPI_MAX: acc[i] = std::max(acc[i], value[i]); break;
+            case MPI_MIN: acc[i] = std::min(acc[i], value[i]); break;
+        }
+    }
+}
+
+// Find the first deliverable message for a receive. Delivery times never decrease per
+// sender, so taking the first ready match never overtakes an earlier message.
+// Returns the queue end if nothing matches yet; `next_ready` gets the earliest pending match.
+inline std::deque<Envelope>::iterator findMatch(Mailbox& box, MPI_Comm comm, int source, int tag,
+                                                Clock::time_point now, Clock::time_point* next_ready) {
+    *next_ready = Clock::time_point::max();
+    for (auto it = box.queue.begin(); it != box.queue.end(); ++it) {
+        if (it->comm != comm) continue;
+        if (source != MPI_ANY_SOURCE && it->source != source) continue;
+        if (tag != MPI_ANY_TAG && it->tag != tag) continue;
+        if (it->ready <= now) return it;
+        *next_ready = std::min(*next_ready, it->ready);
+    }
+    return box.queue.end();
+}
+
+inline void fillStatus(MPI_Status* status, const Envelope& envelope) {
+    if (!status) return;
+    status->MPI_SOURCE = envelope.source;
+    status->MPI_TAG = envelope.tag;
+    status->MPI_ERROR = 0;
+    status->mock_bytes = envelope.bytes.size();
+}
+
+inline void abortAll(int errorcode) {
+    std::cout.flush();
+    std::cerr.flush();
+    std::_Exit(errorcode);
+}
+
+// Try to complete a receive without blocking
+inline bool tryReceive(const PendingRecv& recv, MPI_Status* status) {
+    Mailbox& box = World::instance().mailbox(t_rank);
+    std::lock_guard<std::mutex> lock(box.mutex);
+    Clock::time_point next_ready;
+    auto it = findMatch(box, recv.comm, recv.source, recv.tag, Clock::now(), &next_ready);
+    if (it == box.queue.end()) return false;
+    if (it->bytes.size() > recv.capacity) {
+        std::cerr << "MPI simulator: message truncated on rank " << t_rank << std::endl;
+        abortAll(15);
+    }
+    std::memcpy(recv.buf, it->bytes.data(), it->bytes.size());
+    fillStatus(status, *it);
+    box.queue.erase(it);
+    return true;
+}
+
+inline int envInt(const char* name, int fallback) {
+    const char* value = std::getenv(name);
+    return value ? std::atoi(value) : fallback;
+}
+
+inline double envDouble(const char* name, double fallback) {
+    const char* value = std::getenv(name);
+    return value ? std::atof(value) : fallback;
+}
+
+// Bytes and messages a world rank has sent so far
+inline uint64_t bytesSent(int world_rank) { return World::instance().traffic(world_rank).bytes; }
+inline uint64_t messagesSent(int world_rank) { return World::instance().traffic(world_rank).messages; }
+
+// Run rank_main(argc, argv) on DGRAPH_SIM_RANKS threads, one per rank, and return the
+// first nonzero exit code. With more than one rank, per-rank traffic is printed at the end.
+inline int launch(int argc, char** argv, int (*rank_main)(int, char**)) {
+    const int size = std::max(1, envInt("DGRAPH_SIM_RANKS", 1));
+    World& world = World::instance();
+    world.init(size, envDouble("DGRAPH_SIM_LATENCY_US", 0), envDouble("DGRAPH_SIM_BANDWIDTH_MBPS", 0));
+
+    if (size == 1) return rank_main(argc, argv);
+
+    std::vector<int> codes(size, 0);
+    std::vector<std::thread> ranks;
+    for (int r = 0; r < size; ++r) {
+        ranks.emplace_back([&, r] {
+            t_rank = r;
+            codes[r] = rank_main(argc, argv);
+        });
+    }
+    for (auto& t : ranks) t.join();
+
+    std::cout << "Simulated MPI traffic (" << size << " ranks):" << std::endl;
+    uint64_t total_bytes = 0, total_messages = 0;
+    for (int r = 0; r < size; ++r) {
+        total_bytes += bytesSent(r);
+        total_messages += messagesSent(r);
+        std::cout << "  rank " << r << ": " << std::fixed << std::setprecision(2)
+                  << bytesSent(r) / (1024.0 * 1024.0) << " MiB in " << messagesSent(r) << " messages" << std::endl;
+    }
+    std::cout << "  total: " << total_bytes / (1024.0 * 1024.0) << " MiB in " << total_messages
+              << " messages" << std::defaultfloat << std::endl;
+
+    for (int code : codes) {
+        if (code != 0) return code;
+    }
+    return 0;
+}
+
+} // namespace mock_mpi
+
 inline int MPI_Init_thread(int* argc, char*** argv, int required, int* provided) {
-    (void)argc; (void)argv; (void)required;
+    (void)argc; (void)argv;
     *provided = required;
     return 0;
 }
@@ -31,19 +361,51 @@ inline int MPI_Finalize() {
 }
 
 inline int MPI_Comm_rank(MPI_Comm comm, int* rank) {
-    (void)comm;
-    *rank = 0;
+    *rank = mock_mpi::World::instance().comm(comm).rank_of[mock_mpi::t_rank];
     return 0;
 }
 
 inline int MPI_Comm_size(MPI_Comm comm, int* size) {
-    (void)comm;
-    *size = 1;
+    *size = static_cast<int>(mock_mpi::World::instance().comm(comm).members.size());
     return 0;
 }
 
 inline int MPI_Comm_dup(MPI_Comm comm, MPI_Comm* newcomm) {
-    *newcomm = comm;
+    // Comm rank 0 registers the copy, everyone else picks up its id
+    MPI_Comm created = -1;
+    mock_mpi::Comm& old = mock_mpi::World::instance().comm(comm);
+    if (old.rank_of[mock_mpi::t_rank] == 0) created = mock_mpi::World::instance().addComm(old.members);
+    mock_mpi::collective(comm, &created, 0, 0, [&](mock_mpi::Comm& c, int) {
+        *newcomm = *static_cast<const MPI_Comm*>(c.slots[0]);
+    });
+    return 0;
+}
+
+inline int MPI_Comm_split(MPI_Comm comm, int color, int key, MPI_Comm* newcomm) {
+    // Phase 1: everyone learns every (color, key) and works out its group
+    const int mine[2] = {color, key};
+    std::vector<int> group; // Comm ranks of my group, ordered by (key, rank)
+    mock_mpi::collective(comm, mine, 0, 0, [&](mock_mpi::Comm& c, int) {
+        for (size_t r = 0; r < c.members.size(); ++r) {
+            if (static_cast<const int*>(c.slots[r])[0] == color) group.push_back(static_cast<int>(r));
+        }
+        std::stable_sort(group.begin(), group.end(), [&](int a, int b) {
+            return static_cast<const int*>(c.slots[a])[1] < static_cast<const int*>(c.slots[b])[1];
+        });
+    });
+
+    // Phase 2: the first member of each group registers it and publishes the id
+    mock_mpi::Comm& parent = mock_mpi::World::instance().comm(comm);
+    const int me = parent.rank_of[mock_mpi::t_rank];
+    MPI_Comm created = MPI_UNDEFINED;
+    if (color != MPI_UNDEFINED && group.front() == me) {
+        std::vector<int> members;
+        for (int r : group) members.push_back(parent.members[r]);
+        created = mock_mpi::World::instance().addComm(members);
+    }
+    mock_mpi::collective(comm, &created, 0, 0, [&](mock_mpi::Comm& c, int) {
+        *newcomm = (color == MPI_UNDEFINED) ? MPI_UNDEFINED : *static_cast<const MPI_Comm*>(c.slots[group.front()]);
+    });
     return 0;
 }
 
@@ -53,55 +415,237 @@ inline int MPI_Comm_free(MPI_Comm* comm) {
 }
 
 inline int MPI_Barrier(MPI_Comm comm) {
-    (void)comm;
+    const int size = static_cast<int>(mock_mpi::World::instance().comm(comm).members.size());
+    mock_mpi::collective(comm, nullptr, 0, size - 1, [](mock_mpi::Comm&, int) {});
     return 0;
 }
 
 inline int MPI_Abort(MPI_Comm comm, int errorcode) {
     (void)comm;
     std::cerr << "MPI_Abort called with error " << errorcode << std::endl;
-    exit(errorcode);
+    mock_mpi::abortAll(errorcode);
     return 0;
 }
 
 inline int MPI_Bcast(void* buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
-    (void)buffer; (void)count; (void)datatype; (void)root; (void)comm;
-    // For size=1, Bcast does nothing (root is me)
+    const size_t bytes = count * mock_mpi::typeSize(datatype);
+    mock_mpi::Comm& c = mock_mpi::World::instance().comm(comm);
+    const int peers = static_cast<int>(c.members.size()) - 1;
+    const bool is_root = c.rank_of[mock_mpi::t_rank] == root;
+    mock_mpi::collective(comm, buffer, is_root ? bytes * peers : 0, is_root ? peers : 0,
+                         [&](mock_mpi::Comm& cc, int me) {
+                             if (me != root) std::memcpy(buffer, cc.slots[root], bytes);
+                         });
     return 0;
 }
 
 inline int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
-    (void)op; (void)comm;
-    // For size=1, recv = send
-    size_t bytes = 0;
-    if (datatype == MPI_INT) bytes = count * sizeof(int);
-    else if (datatype == MPI_DOUBLE) bytes = count * sizeof(double);
-    else if (datatype == MPI_UINT64_T) bytes = count * sizeof(uint64_t);
-    
-    std::memcpy(recvbuf, sendbuf, bytes);
+    const size_t bytes = count * mock_mpi::typeSize(datatype);
+    const int peers = static_cast<int>(mock_mpi::World::instance().comm(comm).members.size()) - 1;
+    // Every rank folds the contributions in rank order, so all get bit-identical results
+    std::vector<char> result(bytes);
+    mock_mpi::collective(comm, sendbuf, bytes * peers, peers, [&](mock_mpi::Comm& c, int) {
+        std::memcpy(result.data(), c.slots[0], bytes);
+        for (size_t r = 1; r < c.members.size(); ++r) {
+            switch (datatype) {
+                case MPI_INT:
+                    mock_mpi::reduceInto(reinterpret_cast<int*>(result.data()), static_cast<const int*>(c.slots[r]), count, op);
+                    break;
+                case MPI_DOUBLE:
+                    mock_mpi::reduceInto(reinterpret_cast<double*>(result.data()), static_cast<const double*>(c.slots[r]), count, op);
+                    break;
+                case MPI_UINT64_T:
+                    mock_mpi::reduceInto(reinterpret_cast<uint64_t*>(result.data()), static_cast<const uint64_t*>(c.slots[r]), count, op);
+                    break;
+                case MPI_FLOAT:
+                    mock_mpi::reduceInto(reinterpret_cast<float*>(result.data()), static_cast<const float*>(c.slots[r]), count, op);
+                    break;
+                default:
+                    mock_mpi::reduceInto(reinterpret_cast<char*>(result.data()), static_cast<const char*>(c.slots[r]), count, op);
+                    break;
+            }
+        }
+    });
+    std::memcpy(recvbuf, result.data(), bytes);
     return 0;
 }
 
 inline int MPI_Alltoall(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
                         void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
-    (void)comm; (void)recvcount; (void)recvtype;
-    // For size=1, sendbuf -> recvbuf
-    // sendcount is elements per rank.
-    size_t bytes = 0;
-    if (sendtype == MPI_INT) bytes = sendcount * sizeof(int);
-    // ... others
-    
-    std::memcpy(recvbuf, sendbuf, bytes);
+    (void)recvcount; (void)recvtype;
+    const size_t block = sendcount * mock_mpi::typeSize(sendtype);
+    const int peers = static_cast<int>(mock_mpi::World::instance().comm(comm).members.size()) - 1;
+    mock_mpi::collective(comm, sendbuf, block * peers, peers, [&](mock_mpi::Comm& c, int me) {
+        for (size_t r = 0; r < c.members.size(); ++r) {
+            std::memcpy(static_cast<char*>(recvbuf) + r * block,
+                        static_cast<const char*>(c.slots[r]) + me * block, block);
+        }
+    });
+    return 0;
+}
+
+inline int MPI_Allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                         void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    (void)recvcount; (void)recvtype;
+    const size_t block = sendcount * mock_mpi::typeSize(sendtype);
+    const int peers = static_cast<int>(mock_mpi::World::instance().comm(comm).members.size()) - 1;
+    mock_mpi::collective(comm, sendbuf, block * peers, peers, [&](mock_mpi::Comm& c, int) {
+        for (size_t r = 0; r < c.members.size(); ++r) {
+            std::memcpy(static_cast<char*>(recvbuf) + r * block, c.slots[r], block);
+        }
+    });
+    return 0;
+}
+
+inline int MPI_Allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                          void* recvbuf, const int* recvcounts, const int* displs, MPI_Datatype recvtype, MPI_Comm comm) {
+    const size_t bytes = sendcount * mock_mpi::typeSize(sendtype);
+    const size_t elem = mock_mpi::typeSize(recvtype);
+    const int peers = static_cast<int>(mock_mpi::World::instance().comm(comm).members.size()) - 1;
+    mock_mpi::collective(comm, sendbuf, bytes * peers, peers, [&](mock_mpi::Comm& c, int) {
+        for (size_t r = 0; r < c.members.size(); ++r) {
+            std::memcpy(static_cast<char*>(recvbuf) + displs[r] * elem, c.slots[r], recvcounts[r] * elem);
+        }
+    });
     return 0;
 }
 
 inline int MPI_Alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls, MPI_Datatype sendtype,
                          void* recvbuf, const int* recvcounts, const int* rdispls, MPI_Datatype recvtype, MPI_Comm comm) {
-    (void)comm; (void)recvcounts; (void)recvtype;
-    // For size=1, copy sendbuf[sdispls[0]] to recvbuf[rdispls[0]] with len sendcounts[0]
-    // Assuming type matches and is byte for Engine
-    if (sendtype == MPI_BYTE) {
-        std::memcpy((char*)recvbuf + rdispls[0], (const char*)sendbuf + sdispls[0], sendcounts[0]);
+    struct Contribution {
+        const char* buf;
+        const int* counts;
+        const int* displs;
+        size_t elem;
+    };
+    const Contribution mine{static_cast<const char*>(sendbuf), sendcounts, sdispls, mock_mpi::typeSize(sendtype)};
+    const size_t recv_elem = mock_mpi::typeSize(recvtype);
+
+    mock_mpi::Comm& comm_info = mock_mpi::World::instance().comm(comm);
+    const int me = comm_info.rank_of[mock_mpi::t_rank];
+    uint64_t bytes_out = 0, messages_out = 0;
+    for (size_t r = 0; r < comm_info.members.size(); ++r) {
+        if (static_cast<int>(r) == me || sendcounts[r] == 0) continue;
+        bytes_out += sendcounts[r] * mine.elem;
+        messages_out++;
     }
+
+    mock_mpi::collective(comm, &mine, bytes_out, messages_out, [&](mock_mpi::Comm& c, int my_rank) {
+        for (size_t r = 0; r < c.members.size(); ++r) {
+            const Contribution& peer = *static_cast<const Contribution*>(c.slots[r]);
+            std::memcpy(static_cast<char*>(recvbuf) + rdispls[r] * recv_elem,
+                        peer.buf + peer.displs[my_rank] * peer.elem, recvcounts[r] * recv_elem);
+        }
+    });
+    return 0;
+}
+
+// Point-to-point. Sends are eager: the payload is copied into the destination's mailbox
+// (deliverable after the modelled latency/transfer time) and the request completes at once.
+
+inline int MPI_Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+                     MPI_Request* request) {
+    mock_mpi::World& world = mock_mpi::World::instance();
+    mock_mpi::Comm& c = world.comm(comm);
+    const size_t bytes = count * mock_mpi::typeSize(datatype);
+    const char* data = static_cast<const char*>(buf);
+
+    mock_mpi::Envelope envelope{comm, c.rank_of[mock_mpi::t_rank], tag, std::vector<char>(data, data + bytes), {}};
+    const int dest_world = c.members[dest];
+    if (dest_world != mock_mpi::t_rank) mock_mpi::account(bytes, 1);
+
+    mock_mpi::Mailbox& box = world.mailbox(dest_world);
+    {
+        std::lock_guard<std::mutex> lock(box.mutex);
+        auto ready = mock_mpi::Clock::now();
+        if (world.modelled() && dest_world != mock_mpi::t_rank) {
+            ready += std::chrono::duration_cast<mock_mpi::Clock::duration>(
+                std::chrono::duration<double>(world.cost(bytes, 1)));
+        }
+        ready = std::max(ready, box.last_ready[mock_mpi::t_rank]);
+        box.last_ready[mock_mpi::t_rank] = ready;
+        envelope.ready = ready;
+        box.queue.push_back(std::move(envelope));
+    }
+    box.cv.notify_all();
+    *request = MPI_REQUEST_NULL;
+    return 0;
+}
+
+inline int MPI_Send(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+    MPI_Request request;
+    return MPI_Isend(buf, count, datatype, dest, tag, comm, &request);
+}
+
+inline int MPI_Irecv(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+                     MPI_Request* request) {
+    auto& pending = mock_mpi::t_pending;
+    mock_mpi::PendingRecv recv{buf, count * mock_mpi::typeSize(datatype), source, tag, comm, true};
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (!pending[i].active) {
+            pending[i] = recv;
+            *request = static_cast<int>(i);
+            return 0;
+        }
+    }
+    pending.push_back(recv);
+    *request = static_cast<int>(pending.size() - 1);
+    return 0;
+}
+
+inline int MPI_Test(MPI_Request* request, int* flag, MPI_Status* status) {
+    if (*request == MPI_REQUEST_NULL) {
+        *flag = 1;
+        return 0;
+    }
+    mock_mpi::PendingRecv& recv = mock_mpi::t_pending[*request];
+    *flag = mock_mpi::tryReceive(recv, status) ? 1 : 0;
+    if (*flag) {
+        recv.active = false;
+        *request = MPI_REQUEST_NULL;
+    }
+    return 0;
+}
+
+inline int MPI_Wait(MPI_Request* request, MPI_Status* status) {
+    if (*request == MPI_REQUEST_NULL) return 0;
+    mock_mpi::PendingRecv& recv = mock_mpi::t_pending[*request];
+    mock_mpi::Mailbox& box = mock_mpi::World::instance().mailbox(mock_mpi::t_rank);
+    for (;;) {
+        if (mock_mpi::tryReceive(recv, status)) break;
+        std::unique_lock<std::mutex> lock(box.mutex);
+        mock_mpi::Clock::time_point next_ready;
+        auto it = mock_mpi::findMatch(box, recv.comm, recv.source, recv.tag, mock_mpi::Clock::now(), &next_ready);
+        if (it != box.queue.end()) continue;
+        if (next_ready != mock_mpi::Clock::time_point::max()) {
+            box.cv.wait_until(lock, next_ready);
+        } else {
+            box.cv.wait(lock);
+        }
+    }
+    recv.active = false;
+    *request = MPI_REQUEST_NULL;
+    return 0;
+}
+
+inline int MPI_Iprobe(int source, int tag, MPI_Comm comm, int* flag, MPI_Status* status) {
+    mock_mpi::Mailbox& box = mock_mpi::World::instance().mailbox(mock_mpi::t_rank);
+    std::lock_guard<std::mutex> lock(box.mutex);
+    mock_mpi::Clock::time_point next_ready;
+    auto it = mock_mpi::findMatch(box, comm, source, tag, mock_mpi::Clock::now(), &next_ready);
+    *flag = (it != box.queue.end()) ? 1 : 0;
+    if (*flag) mock_mpi::fillStatus(status, *it);
+    return 0;
+}
+
+inline int MPI_Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+                    MPI_Status* status) {
+    MPI_Request request;
+    MPI_Irecv(buf, count, datatype, source, tag, comm, &request);
+    return MPI_Wait(&request, status);
+}
+
+inline int MPI_Get_count(const MPI_Status* status, MPI_Datatype datatype, int* count) {
+    *count = static_cast<int>(status->mock_bytes / mock_mpi::typeSize(datatype));
     return 0;
 }
@@ -1,8 +1,13 @@
 import argparse
 import os
+import struct
 from gensim.models import Word2Vec
 import glob
 
+# Binary walk files written by `rw --format=binary`: this magic, then per walk a
+# little-endian uint32 length followed by that many uint64 vertex ids
+BINARY_MAGIC = b"DGWALKS1"
+
 def train_node2vec(walks_files, output_file, dimensions=128, window=5, min_count=1, workers=4):
     """
     Train Node2Vec embeddings using Gensim Word2Vec.
@@ -12,10 +17,27 @@ def train_node2vec(walks_files, output_file, dimensions=128, window=5, min_count
             self.files = glob.glob(file_patterns)
             
         def __iter__(self):
+            # Files are streamed, so the walks never have to fit in memory at once
             for fname in self.files:
-                with open(fname, 'r') as f:
-                    for line in f:
-                        yield line.strip().split()
+                with open(fname, 'rb') as f:
+                    if f.read(len(BINARY_MAGIC)) == BINARY_MAGIC:
+                        yield from self._binary_walks(f)
+                    else:
+                        f.seek(0)
+                        for line in f:
+                            walk = line.decode().split()
+                            if walk:
+                                yield walk
+
+        @staticmethod
+        def _binary_walks(f):
+            while True:
+                header = f.read(4)
+                if len(header) < 4:
+                    return
+                (length,) = struct.unpack("<I", header)
+                ids = struct.unpack("<%dQ" % length, f.read(8 * length))
+                yield [str(v) for v in ids]
 
     print(f"Reading walks from {walks_files}...")
     walks = WalkIterator(walks_files)
@@ -29,7 +51,7 @@ def train_node2vec(walks_files, output_file, dimensions=128, window=5, min_count
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Train Node2Vec embeddings from random walks")
-    parser.add_argument("--walks", type=str, default="walks_out_*.txt", help="Glob pattern for walk files")
+    parser.add_argument("--walks", type=str, default="walks_out_*", help="Glob pattern for walk files (text or binary)")
     parser.add_argument("--output", type=str, default="embeddings.txt", help="Output file for embeddings")
     parser.add_argument("--dim", type=int, default=128, help="Embedding dimensions")
     
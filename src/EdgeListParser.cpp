@@ -0,0 +1,136 @@
+#include "dgraph/EdgeListParser.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace dgraph {
+
+namespace {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline uint64_t skipBlanks(const char* data, uint64_t pos, uint64_t size) {
+    while (pos < size && isBlank(data[pos])) ++pos;
+    return pos;
+}
+
+inline uint64_t skipLine(const char* data, uint64_t pos, uint64_t size) {
+    while (pos < size && data[pos] != '\n') ++pos;
+    return pos < size ? pos + 1 : size;
+}
+
+// Returns false if no digits were found at pos
+inline bool scanUInt(const char* data, uint64_t& pos, uint64_t size, uint64_t& value) {
+    uint64_t start = pos;
+    uint64_t v = 0;
+    while (pos < size && isDigit(data[pos])) {
+        v = v * 10 + static_cast<uint64_t>(data[pos] - '0');
+        ++pos;
+    }
+    value = v;
+    return pos != start;
+}
+
+// Decimal weights with an optional exponent ("2", "0.25", "-1.5", "1e-3"). Returns false,
+// leaving value untouched, unless a complete number ending at a separator was read.
+inline bool scanWeight(const char* data, uint64_t& pos, uint64_t size, EdgeWeight& value) {
+    uint64_t p = pos;
+    bool negative = false;
+    if (p < size && (data[p] == '-' || data[p] == '+')) {
+        negative = data[p] == '-';
+        ++p;
+    }
+    double v = 0.0;
+    bool digits = false;
+    while (p < size && isDigit(data[p])) {
+        v = v * 10.0 + (data[p] - '0');
+        digits = true;
+        ++p;
+    }
+    if (p < size && data[p] == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p < size && isDigit(data[p])) {
+            v += (data[p] - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+            ++p;
+        }
+    }
+    if (!digits) return false;
+    if (p < size && (data[p] == 'e' || data[p] == 'E')) {
+        ++p;
+        bool negative_exponent = false;
+        if (p < size && (data[p] == '-' || data[p] == '+')) {
+            negative_exponent = data[p] == '-';
+            ++p;
+        }
+        uint64_t exponent = 0;
+        if (!scanUInt(data, p, size, exponent)) return false;
+        v *= std::pow(10.0, negative_exponent ? -static_cast<double>(exponent) : static_cast<double>(exponent));
+    }
+    if (p < size && !isBlank(data[p]) && data[p] != '\n') return false;
+    value = static_cast<EdgeWeight>(negative ? -v : v);
+    pos = p;
+    return true;
+}
+
+} // namespace
+
+uint64_t parseEdgeListHeader(const char* data, uint64_t size, VertexId& num_vertices) {
+    uint64_t pos = 0;
+    while (pos < size) {
+        pos = skipBlanks(data, pos, size);
+        if (pos < size && (data[pos] == '\n' || data[pos] == '#' || data[pos] == '%')) {
+            pos = skipLine(data, pos, size);
+            continue;
+        }
+        if (!scanUInt(data, pos, size, num_vertices)) {
+            throw std::runtime_error("Edge list is missing the vertex count header");
+        }
+        return skipLine(data, pos, size);
+    }
+    throw std::runtime_error("Edge list is empty");
+}
+
+void parseEdgeListRange(const char* data, uint64_t size, uint64_t begin, uint64_t end,
+                        std::vector<Edge>& edges) {
+    if (end > size) end = size;
+    uint64_t pos = begin;
+
+    // The line containing `begin` belongs to the previous range unless we start on a line boundary
+    if (pos > 0 && pos < size && data[pos - 1] != '\n') {
+        pos = skipLine(data, pos, size);
+    }
+
+    while (pos < end) {
+        uint64_t line_start = pos;
+        pos = skipBlanks(data, pos, size);
+
+        Edge e;
+        e.weight = 1.0f;
+        if (!scanUInt(data, pos, size, e.src)) {
+            // Blank line, comment or garbage: ignore the line
+            pos = skipLine(data, line_start, size);
+            continue;
+        }
+        pos = skipBlanks(data, pos, size);
+        if (!scanUInt(data, pos, size, e.dst)) {
+            pos = skipLine(data, line_start, size);
+            continue;
+        }
+        // Anything but a number in the third column (e.g. a trailing comment) keeps the default
+        pos = skipBlanks(data, pos, size);
+        EdgeWeight weight;
+        if (scanWeight(data, pos, size, weight)) e.weight = weight;
+        edges.push_back(e);
+        pos = skipLine(data, pos, size);
+    }
+}
+
+} // namespace dgraph
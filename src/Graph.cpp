@@ -1,8 +1,16 @@
 #include "dgraph/Graph.hpp"
+#include "dgraph/Snapshot.hpp"
+#include "dgraph/EdgeListParser.hpp"
+#include "dgraph/Exchange.hpp"
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace dgraph {
 
@@ -11,97 +19,1118 @@ Graph::Graph(MPI_Comm comm) : comm_(comm) {
     MPI_Comm_size(comm_, &size_);
 }
 
-Graph::~Graph() {}
+Graph::~Graph() {
+    releaseEdgeGrid();
+}
 
 void Graph::distributeVertices(VertexId total_vertices) {
     global_num_vertices_ = total_vertices;
-    VertexId remainder = total_vertices % size_;
-    VertexId chunk = total_vertices / size_;
+    partition_ = Partition::uniform(total_vertices, size_);
+    strategy_ = PartitionStrategy::Range;
+    original_ids_.clear();
 
     // Determine start and end for this rank
-    if (static_cast<VertexId>(rank_) < remainder) {
-        start_vertex_id_ = rank_ * (chunk + 1);
-        end_vertex_id_ = start_vertex_id_ + chunk + 1;
-    } else {
-        start_vertex_id_ = rank_ * chunk + remainder;
-        end_vertex_id_ = start_vertex_id_ + chunk;
-    }
+    start_vertex_id_ = partition_.rangeStart(rank_);
+    end_vertex_id_ = partition_.rangeEnd(rank_);
     local_num_vertices_ = end_vertex_id_ - start_vertex_id_;
 
     // Initialize row_ptr
-    row_ptr_.assign(local_num_vertices_ + 1, 0);
+    row_ptr_storage_.assign(local_num_vertices_ + 1, 0);
+    bindStorage();
+}
+
+void Graph::buildCSR(std::vector<Edge>& edges) {
+    std::vector<std::vector<Edge>> parts(1);
+    parts[0].swap(edges);
+    buildCSR(parts);
+}
+
+void Graph::buildCSR(std::vector<std::vector<Edge>>& parts) {
+    // Counting-sort construction: degree count, prefix sum, scatter, per-row sort.
+    // Every array is sized exactly once and each part is freed as soon as it is scattered,
+    // so peak memory is the edges not yet scattered plus the final CSR.
+    uint64_t num_edges = 0;
+    for (const auto& part : parts) num_edges += part.size();
+    std::vector<uint64_t>& row_ptr = row_ptr_storage_;
+    row_ptr.assign(local_num_vertices_ + 1, 0);
+
+    // Pass 1: out-degree of every local source
+    for (const auto& part : parts) {
+        const uint64_t count = part.size();
+        #pragma omp parallel for
+        for (uint64_t e = 0; e < count; ++e) {
+            VertexId local_src = part[e].src - start_vertex_id_;
+            #pragma omp atomic
+            row_ptr[local_src + 1]++;
+        }
+    }
+
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        row_ptr[i + 1] += row_ptr[i];
+    }
+
+    // Pass 2: scatter edges into their rows
+    col_ind_storage_.resize(num_edges);
+    weights_storage_.resize(num_edges);
+    std::vector<uint64_t> cursor(row_ptr.begin(), row_ptr.end() - 1);
+
+    for (auto& part : parts) {
+        const uint64_t count = part.size();
+        #pragma omp parallel for
+        for (uint64_t e = 0; e < count; ++e) {
+            VertexId local_src = part[e].src - start_vertex_id_;
+            uint64_t pos;
+            #pragma omp atomic capture
+            pos = cursor[local_src]++;
+            col_ind_storage_[pos] = part[e].dst;
+            weights_storage_[pos] = part[e].weight;
+        }
+        std::vector<Edge>().swap(part);
+    }
+    std::vector<std::vector<Edge>>().swap(parts);
+    std::vector<uint64_t>().swap(cursor);
+
+    // Sort neighbors for better cache locality / intersection perf.
+    // Weights travel with their neighbor, so each thread keeps one reusable scratch row.
+    #pragma omp parallel
+    {
+        std::vector<std::pair<VertexId, EdgeWeight>> scratch;
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            uint64_t begin = row_ptr[i];
+            uint64_t end = row_ptr[i + 1];
+            if (end - begin < 2) continue;
+
+            scratch.clear();
+            for (uint64_t k = begin; k < end; ++k) {
+                scratch.emplace_back(col_ind_storage_[k], weights_storage_[k]);
+            }
+            std::sort(scratch.begin(), scratch.end());
+            for (uint64_t k = begin; k < end; ++k) {
+                col_ind_storage_[k] = scratch[k - begin].first;
+                weights_storage_[k] = scratch[k - begin].second;
+            }
+        }
+    }
+
+    bindStorage();
+}
+
+void Graph::bindStorage() {
+    snapshot_.close();
+    encoding_ = AdjacencyEncoding::Plain;
+    col_ind32_.clear();
+    packed_adj_.clear();
+    packed_offsets_.clear();
+    in_edges_ = InEdgeIndex();
+    releaseEdgeGrid();
+    row_ptr_ = ArrayView<uint64_t>(row_ptr_storage_);
+    col_ind_ = ArrayView<VertexId>(col_ind_storage_);
+    weights_ = ArrayView<EdgeWeight>(weights_storage_);
+    computeInverseDegrees();
+}
+
+void Graph::computeInverseDegrees() {
+    inv_out_degree_.resize(local_num_vertices_);
+    #pragma omp parallel for
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        VertexId degree = getOutDegree(i);
+        inv_out_degree_[i] = degree > 0 ? 1.0 / degree : 0.0;
+    }
 }
 
 void Graph::loadFromFile(const std::string& filename) {
-    std::ifstream infile(filename);
-    if (!infile.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
+    if (isSnapshot(filename)) {
+        loadSnapshot(filename);
+        return;
     }
 
+    auto load_start = std::chrono::steady_clock::now();
+
+    // Every rank maps the file but only touches the pages of its own byte range
+    MappedFile file;
+    file.open(filename);
+    const char* data = reinterpret_cast<const char*>(file.data());
+    uint64_t file_size = file.size();
+
     VertexId num_v;
+    uint64_t data_offset = 0;
     if (rank_ == 0) {
-        infile >> num_v;
+        data_offset = parseEdgeListHeader(data, file_size, num_v);
     }
     
-    // Broadcast number of vertices
+    // Broadcast number of vertices and where the edge lines start
     MPI_Bcast(&num_v, 1, MPI_UINT64_T, 0, comm_);
+    MPI_Bcast(&data_offset, 1, MPI_UINT64_T, 0, comm_);
     distributeVertices(num_v);
 
-    // Temporary storage for local adjacency list
-    // Using vector of vectors to easily append edges
-    std::vector<std::vector<VertexId>> local_adj(local_num_vertices_);
-    
-    // Re-open or reset file to read edges
-    // In a real distributed system, we'd use MPI-IO or parallel file system strategies.
-    // Here, for simplicity/portability, we accept the cost of re-reading or all-reading.
-    // Optimization: Only Rank 0 reads and scatters? No, too much memory.
-    // Optimization: All read, filter.
-    
-    // Reset to beginning (Rank 0 already read one line, others need to start)
-    // Actually simpler if everyone opens their own stream or seeks.
-    // Rank 0 is at line 2. Others are at line 1.
-    // Let's close and reopen for everyone to be safe and simple.
-    infile.close();
-    infile.open(filename);
-    
-    VertexId dummy;
-    infile >> dummy; // Skip num vertices
+    // Each rank parses a disjoint byte range, split further across threads.
+    // Ranges are aligned to line boundaries by the parser itself.
+    uint64_t body = file_size - data_offset;
+    uint64_t rank_begin = data_offset + body * rank_ / size_;
+    uint64_t rank_end = data_offset + body * (rank_ + 1) / size_;
 
-    VertexId src, dst;
-    uint64_t edge_count = 0;
-    
-    while (infile >> src >> dst) {
-        // If src belongs to this rank
-        if (src >= start_vertex_id_ && src < end_vertex_id_) {
-            VertexId local_src = src - start_vertex_id_;
-            if (local_src < local_num_vertices_) {
-                 local_adj[local_src].push_back(dst);
-                 edge_count++;
+    // Per-thread buckets by owner of the source vertex, filled straight from the scanner.
+    // Threads scan their range a chunk at a time so the scanner's own buffer stays small,
+    // and buckets grow in fixed-size blocks: no reallocation copies, no growth slack.
+    const uint64_t kParseChunk = uint64_t(1) << 20;
+    const size_t kBlockEdges = size_t(1) << 14;
+    using Blocks = std::vector<std::vector<Edge>>;
+    std::vector<std::vector<Blocks>> buckets(omp_get_max_threads());
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        uint64_t span = rank_end - rank_begin;
+        uint64_t begin = rank_begin + span * tid / nthreads;
+        uint64_t end = rank_begin + span * (tid + 1) / nthreads;
+
+        std::vector<Blocks>& mine = buckets[tid];
+        mine.resize(size_);
+        std::vector<Edge> parsed;
+        for (uint64_t chunk = begin; chunk < end; chunk += kParseChunk) {
+            parsed.clear();
+            parseEdgeListRange(data, file_size, chunk, std::min(chunk + kParseChunk, end), parsed);
+            for (const Edge& e : parsed) {
+                if (e.src >= global_num_vertices_) continue;
+                Blocks& blocks = mine[ownerOf(e.src)];
+                if (blocks.empty() || blocks.back().size() == kBlockEdges) blocks.emplace_back();
+                blocks.back().push_back(e);
             }
         }
     }
-    infile.close();
+    file.close();
 
-    // Convert to CSR
-    // row_ptr_ is already sized
-    row_ptr_[0] = 0;
-    col_ind_.reserve(edge_count);
-    // weights_.reserve(edge_count); // Assuming unweighted for now or default weight 1.0
+    // Pack the edges for other ranks into one send buffer grouped by destination, freeing
+    // each block as it is copied. Our own blocks go to buildCSR as they are.
+    std::vector<size_t> send_counts(size_, 0);
+    for (const auto& mine : buckets) {
+        for (int r = 0; r < static_cast<int>(mine.size()); ++r) {
+            if (r == rank_) continue;
+            for (const auto& block : mine[r]) send_counts[r] += block.size();
+        }
+    }
+    ExchangePlan plan;
+    planExchange<Edge>(comm_, send_counts, plan);
 
-    for (size_t i = 0; i < local_num_vertices_; ++i) {
-        // Sort neighbors for better cache locality / intersection perf
-        std::sort(local_adj[i].begin(), local_adj[i].end());
-        
-        for (const auto& neighbor : local_adj[i]) {
-            col_ind_.push_back(neighbor);
-            weights_.push_back(1.0f); // Default weight
+    std::vector<Edge> send;
+    send.reserve(plan.total_send);
+    std::vector<std::vector<Edge>> parts;
+    for (int r = 0; r < size_; ++r) {
+        for (auto& mine : buckets) {
+            if (mine.empty()) continue;
+            for (auto& block : mine[r]) {
+                if (r == rank_) {
+                    parts.emplace_back().swap(block);
+                } else {
+                    send.insert(send.end(), block.begin(), block.end());
+                    std::vector<Edge>().swap(block);
+                }
+            }
         }
-        row_ptr_[i + 1] = col_ind_.size();
     }
-    
+    std::vector<std::vector<Blocks>>().swap(buckets);
+
+    // Ship every edge to the rank owning its source
+    std::vector<Edge>& received = parts.emplace_back(plan.total_recv);
+    exchangeKnownCounts(comm_, send.data(), plan.send_counts, received.data(), plan.recv_counts);
+    std::vector<Edge>().swap(send);
+
+    uint64_t edge_count = 0;
+    for (const auto& part : parts) edge_count += part.size();
+    buildCSR(parts);
+
+    // Aggregate throughput is bounded by the slowest rank
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count();
+    double max_elapsed = 0.0;
+    MPI_Allreduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, comm_);
+
     if (rank_ == 0) {
+        double mb = file_size / (1024.0 * 1024.0);
         std::cout << "Graph loaded. Global Vertices: " << global_num_vertices_ 
-                  << ". Local edges on Rank 0: " << edge_count << std::endl;
+                  << ". Local edges on Rank 0: " << edge_count
+                  << ". Ingest: " << mb << " MiB in " << max_elapsed << " s ("
+                  << (max_elapsed > 0 ? mb / max_elapsed : 0.0) << " MiB/s)" << std::endl;
+    }
+}
+
+template <typename RelabelFn>
+void Graph::redistribute(const Partition& target, RelabelFn relabel, bool relabels) {
+    if (encoding_ != AdjacencyEncoding::Plain) {
+        throw std::runtime_error("Repartition the graph before compressing its adjacency");
+    }
+
+    // Input-file ids travel with their rows once vertices stop being numbered as in the file
+    struct Row {
+        VertexId id;
+        VertexId original;
+    };
+    const bool carry_ids = relabels || isRelabeled();
+
+    std::vector<std::vector<Edge>> outboxes(size_);
+    std::vector<std::vector<Row>> rows(size_);
+    #pragma omp parallel
+    {
+        std::vector<std::vector<Edge>> thread_outboxes(size_);
+        std::vector<std::vector<Row>> thread_rows(size_);
+
+        #pragma omp for nowait schedule(dynamic, 1024)
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            VertexId src = relabel(start_vertex_id_ + i);
+            int owner = target.ownerOf(src);
+            if (carry_ids) thread_rows[owner].push_back({src, originalId(i)});
+            for (uint64_t e = row_ptr_[i]; e < row_ptr_[i + 1]; ++e) {
+                thread_outboxes[owner].push_back({src, relabel(col_ind_[e]), weights_[e]});
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int r = 0; r < size_; ++r) {
+                outboxes[r].insert(outboxes[r].end(), thread_outboxes[r].begin(), thread_outboxes[r].end());
+                rows[r].insert(rows[r].end(), thread_rows[r].begin(), thread_rows[r].end());
+            }
+        }
+    }
+
+    std::vector<Edge> edges;
+    exchangeBuffers(comm_, outboxes, edges);
+    std::vector<std::vector<Edge>>().swap(outboxes);
+    std::vector<Row> received_rows;
+    exchangeBuffers(comm_, rows, received_rows);
+
+    partition_ = target;
+    start_vertex_id_ = partition_.rangeStart(rank_);
+    end_vertex_id_ = partition_.rangeEnd(rank_);
+    local_num_vertices_ = end_vertex_id_ - start_vertex_id_;
+
+    original_ids_.clear();
+    if (carry_ids) {
+        original_ids_.resize(local_num_vertices_);
+        for (const Row& row : received_rows) original_ids_[row.id - start_vertex_id_] = row.original;
+    }
+    buildCSR(edges);
+}
+
+std::vector<VertexId> Graph::edgeBalancedBoundaries() const {
+    // A vertex costs its out-degree + 1, so ranges full of isolated vertices still count
+    uint64_t mine = numLocalEdges() + local_num_vertices_;
+    std::vector<uint64_t> costs(size_);
+    MPI_Allgather(&mine, 1, MPI_UINT64_T, costs.data(), 1, MPI_UINT64_T, comm_);
+    uint64_t before = 0, total = 0;
+    for (int r = 0; r < size_; ++r) {
+        if (r < rank_) before += costs[r];
+        total += costs[r];
+    }
+
+    // Every cut point k * total / P falls inside exactly one rank's cost range; that rank
+    // finds the first of its vertices reaching it (the prefix cost is row_ptr[i] + i)
+    std::vector<VertexId> found(size_ + 1, 0);
+    for (int k = 1; k < size_; ++k) {
+        uint64_t cut = total / size_ * k + total % size_ * k / size_;
+        if (cut < before || cut >= before + mine) continue;
+        VertexId lo = 0, hi = local_num_vertices_;
+        while (lo < hi) {
+            VertexId mid = lo + (hi - lo) / 2;
+            if (before + row_ptr_[mid] + mid >= cut) hi = mid;
+            else lo = mid + 1;
+        }
+        found[k] = start_vertex_id_ + lo;
+    }
+
+    std::vector<VertexId> starts(size_ + 1, 0);
+    MPI_Allreduce(found.data(), starts.data(), size_ + 1, MPI_UINT64_T, MPI_MAX, comm_);
+    starts[size_] = global_num_vertices_;
+    return starts;
+}
+
+std::vector<int32_t> Graph::streamingLDG() const {
+    // Linear Deterministic Greedy: stream vertices and put each where most of its (already
+    // placed) neighbors are, damped by how full that part is. Every rank streams its own
+    // vertices in batches and learns everyone's placements after each batch, so this keeps
+    // a replicated 4-byte assignment per global vertex. Only out-neighbors are known locally.
+    const int kBatches = 16;
+    const double capacity = std::max(1.0, 1.05 * global_num_vertices_ / size_);
+
+    std::vector<int32_t> assignment(global_num_vertices_, -1);
+    std::vector<uint64_t> sizes(size_, 0);
+    std::vector<uint32_t> score(size_, 0);
+    std::vector<int> touched;
+
+    for (int b = 0; b < kBatches; ++b) {
+        VertexId begin = local_num_vertices_ * b / kBatches;
+        VertexId end = local_num_vertices_ * (b + 1) / kBatches;
+
+        // Placements of this batch, flattened as (vertex, part) pairs
+        std::vector<uint64_t> placed;
+        placed.reserve(2 * (end - begin));
+        std::vector<uint64_t> added(size_, 0);
+
+        for (VertexId i = begin; i < end; ++i) {
+            touched.clear();
+            for (VertexId w : neighbors(i)) {
+                int32_t p = assignment[w];
+                if (p >= 0 && score[p]++ == 0) touched.push_back(p);
+            }
+
+            // Other ranks are assumed to fill parts at our rate until the batch is synchronized
+            int best = -1;
+            double best_score = -1.0, best_load = 0.0;
+            int emptiest = 0;
+            double emptiest_load = -1.0;
+            for (int p = 0; p < size_; ++p) {
+                double load = static_cast<double>(sizes[p] + added[p] * size_);
+                if (emptiest_load < 0 || load < emptiest_load) {
+                    emptiest = p;
+                    emptiest_load = load;
+                }
+                if (load >= capacity) continue;
+                double s = score[p] * (1.0 - load / capacity);
+                if (s > best_score || (s == best_score && load < best_load)) {
+                    best = p;
+                    best_score = s;
+                    best_load = load;
+                }
+            }
+            if (best < 0) best = emptiest;
+            for (int p : touched) score[p] = 0;
+
+            VertexId v = start_vertex_id_ + i;
+            assignment[v] = best;
+            added[best]++;
+            placed.push_back(v);
+            placed.push_back(static_cast<uint64_t>(best));
+        }
+
+        int count = static_cast<int>(placed.size());
+        std::vector<int> counts(size_), displs(size_, 0);
+        MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, comm_);
+        for (int r = 1; r < size_; ++r) displs[r] = displs[r - 1] + counts[r - 1];
+        std::vector<uint64_t> all(displs[size_ - 1] + counts[size_ - 1]);
+        MPI_Allgatherv(placed.data(), count, MPI_UINT64_T, all.data(), counts.data(), displs.data(),
+                       MPI_UINT64_T, comm_);
+        for (size_t k = 0; k < all.size(); k += 2) assignment[all[k]] = static_cast<int32_t>(all[k + 1]);
+
+        std::vector<uint64_t> global_added(size_, 0);
+        MPI_Allreduce(added.data(), global_added.data(), size_, MPI_UINT64_T, MPI_SUM, comm_);
+        for (int p = 0; p < size_; ++p) sizes[p] += global_added[p];
+    }
+    return assignment;
+}
+
+void Graph::repartition(PartitionStrategy strategy) {
+    if (strategy == strategy_ && strategy == PartitionStrategy::Range && !isRelabeled()) return;
+    auto start = std::chrono::steady_clock::now();
+    auto same_id = [](VertexId v) { return v; };
+
+    switch (strategy) {
+        case PartitionStrategy::Range:
+            redistribute(Partition::uniform(global_num_vertices_, size_), same_id, false);
+            break;
+        case PartitionStrategy::EdgeBalanced:
+            redistribute(Partition::fromBoundaries(edgeBalancedBoundaries()), same_id, false);
+            break;
+        case PartitionStrategy::Hash: {
+            // Vertex v goes to rank v mod P and becomes the (v / P)-th vertex there,
+            // which makes the ranges exactly as large as the uniform ones
+            Partition target = Partition::uniform(global_num_vertices_, size_);
+            const VertexId parts = size_;
+            redistribute(target, [&](VertexId v) { return target.rangeStart(v % parts) + v / parts; }, true);
+            break;
+        }
+        case PartitionStrategy::LDG: {
+            // Number every part's vertices consecutively, keeping their relative order
+            std::vector<int32_t> assignment = streamingLDG();
+            std::vector<VertexId> starts(size_ + 1, 0);
+            for (int32_t p : assignment) starts[p + 1]++;
+            for (int r = 0; r < size_; ++r) starts[r + 1] += starts[r];
+            std::vector<VertexId> next_ids(global_num_vertices_);
+            std::vector<VertexId> cursor(starts.begin(), starts.end() - 1);
+            for (VertexId v = 0; v < global_num_vertices_; ++v) next_ids[v] = cursor[assignment[v]]++;
+            std::vector<int32_t>().swap(assignment);
+            redistribute(Partition::fromBoundaries(starts), [&](VertexId v) { return next_ids[v]; }, true);
+            break;
+        }
+    }
+    strategy_ = strategy;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double max_elapsed = 0.0;
+    MPI_Allreduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, comm_);
+    if (rank_ == 0) {
+        std::cout << "Repartitioned (" << partitionStrategyName(strategy) << ") in " << max_elapsed << " s" << std::endl;
+    }
+}
+
+VertexId Graph::internalId(VertexId original) const {
+    if (!isRelabeled()) return original;
+    std::vector<VertexId> ids{original};
+    toInternalIds(ids);
+    return ids[0] < global_num_vertices_ ? ids[0] : std::numeric_limits<VertexId>::max();
+}
+
+void Graph::toInternalIds(std::vector<VertexId>& ids) const {
+    if (!isRelabeled()) {
+        for (VertexId& v : ids) v = std::min(v, global_num_vertices_);
+        return;
+    }
+
+    // One pass over the local vertices answers every wanted id this rank owns
+    std::vector<VertexId> wanted(ids);
+    std::sort(wanted.begin(), wanted.end());
+    wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+    std::vector<VertexId> found(wanted.size(), global_num_vertices_);
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        auto it = std::lower_bound(wanted.begin(), wanted.end(), original_ids_[i]);
+        if (it != wanted.end() && *it == original_ids_[i]) found[it - wanted.begin()] = start_vertex_id_ + i;
+    }
+    std::vector<VertexId> global(found.size());
+    MPI_Allreduce(found.data(), global.data(), static_cast<int>(found.size()), MPI_UINT64_T, MPI_MIN, comm_);
+
+    for (VertexId& v : ids) v = global[std::lower_bound(wanted.begin(), wanted.end(), v) - wanted.begin()];
+}
+
+template <typename AnswerFn>
+std::vector<VertexId> Graph::askOwners(const std::vector<VertexId>& wanted, AnswerFn answer) const {
+    // Sorted ids are already grouped by owner, so replies line up with `wanted`
+    std::vector<std::vector<VertexId>> requests(size_);
+    for (VertexId v : wanted) requests[ownerOf(v)].push_back(v);
+    std::vector<VertexId> asked;
+    std::vector<size_t> asked_counts;
+    exchangeBuffers(comm_, requests, asked, &asked_counts);
+
+    std::vector<std::vector<VertexId>> answers(size_);
+    size_t pos = 0;
+    for (int r = 0; r < size_; ++r) {
+        answers[r].reserve(asked_counts[r]);
+        for (size_t k = 0; k < asked_counts[r]; ++k, ++pos) {
+            answers[r].push_back(answer(asked[pos] - start_vertex_id_));
+        }
+    }
+    std::vector<VertexId> replies;
+    exchangeBuffers(comm_, answers, replies);
+    return replies;
+}
+
+void Graph::toOriginalIds(std::vector<VertexId>& ids) const {
+    if (!isRelabeled()) return;
+
+    // Ask every owner once per distinct id
+    std::vector<VertexId> wanted;
+    for (VertexId v : ids) {
+        if (v < global_num_vertices_) wanted.push_back(v);
+    }
+    std::sort(wanted.begin(), wanted.end());
+    wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+    std::vector<VertexId> replies = askOwners(wanted, [this](VertexId local_id) { return original_ids_[local_id]; });
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < ids.size(); ++k) {
+        if (ids[k] >= global_num_vertices_) continue;
+        ids[k] = replies[std::lower_bound(wanted.begin(), wanted.end(), ids[k]) - wanted.begin()];
+    }
+}
+
+void Graph::reorder(VertexOrdering ordering) {
+    auto start = std::chrono::steady_clock::now();
+    double gap_before = averageNeighborGap();
+
+    // Undirected local subgraph: both directions of every edge that stays on this rank
+    LocalAdjacency adj;
+    adj.row_ptr.assign(local_num_vertices_ + 1, 0);
+    adj.out_degree.resize(local_num_vertices_);
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        adj.out_degree[i] = getOutDegree(i);
+        for (VertexId w : neighbors(i)) {
+            if (w < start_vertex_id_ || w >= end_vertex_id_ || w - start_vertex_id_ == i) continue;
+            adj.row_ptr[i + 1]++;
+            adj.row_ptr[w - start_vertex_id_ + 1]++;
+        }
+    }
+    for (VertexId i = 0; i < local_num_vertices_; ++i) adj.row_ptr[i + 1] += adj.row_ptr[i];
+    adj.neighbors.resize(adj.row_ptr.back());
+    std::vector<uint64_t> cursor(adj.row_ptr.begin(), adj.row_ptr.end() - 1);
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        for (VertexId w : neighbors(i)) {
+            if (w < start_vertex_id_ || w >= end_vertex_id_ || w - start_vertex_id_ == i) continue;
+            adj.neighbors[cursor[i]++] = w - start_vertex_id_;
+            adj.neighbors[cursor[w - start_vertex_id_]++] = i;
+        }
+    }
+    std::vector<uint64_t>().swap(cursor);
+
+    // Compact every row in place after sorting out duplicates (reciprocal edges appear twice)
+    uint64_t write = 0;
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        auto begin = adj.neighbors.begin() + adj.row_ptr[i];
+        auto end = adj.neighbors.begin() + adj.row_ptr[i + 1];
+        std::sort(begin, end);
+        auto last = std::unique(begin, end);
+        adj.row_ptr[i] = write;
+        write = std::copy(begin, last, adj.neighbors.begin() + write) - adj.neighbors.begin();
+    }
+    adj.row_ptr[local_num_vertices_] = write;
+    adj.neighbors.resize(write);
+
+    std::vector<VertexId> keys(local_num_vertices_);
+    for (VertexId i = 0; i < local_num_vertices_; ++i) keys[i] = originalId(i);
+    std::vector<VertexId> position = computeOrdering(ordering, adj, keys);
+    adj = LocalAdjacency();
+
+    // New ids of remote neighbors come from their owners
+    std::vector<VertexId> remote;
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        for (VertexId w : neighbors(i)) {
+            if (w < start_vertex_id_ || w >= end_vertex_id_) remote.push_back(w);
+        }
+    }
+    std::sort(remote.begin(), remote.end());
+    remote.erase(std::unique(remote.begin(), remote.end()), remote.end());
+    std::vector<VertexId> remote_ids = askOwners(remote, [&](VertexId local_id) { return start_vertex_id_ + position[local_id]; });
+
+    const VertexId first = start_vertex_id_, last = end_vertex_id_;
+    redistribute(partition_, [&](VertexId v) {
+        if (v >= first && v < last) return first + position[v - first];
+        return remote_ids[std::lower_bound(remote.begin(), remote.end(), v) - remote.begin()];
+    }, true);
+    ordering_ = ordering;
+
+    double gap_after = averageNeighborGap();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double max_elapsed = 0.0;
+    MPI_Allreduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, comm_);
+    if (rank_ == 0) {
+        std::cout << "Reordered (" << vertexOrderingName(ordering) << ") in " << max_elapsed
+                  << " s. Average neighbor id gap: " << gap_before << " -> " << gap_after << std::endl;
+    }
+}
+
+double Graph::averageNeighborGap() const {
+    // Rows are sorted, so consecutive neighbors are never further apart than needed
+    uint64_t sums[2] = {0, 0};
+    uint64_t gap_sum = 0, gaps = 0;
+    #pragma omp parallel for reduction(+:gap_sum, gaps) schedule(dynamic, 1024)
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        bool first = true;
+        VertexId prev = 0;
+        for (VertexId w : neighbors(i)) {
+            if (!first) {
+                gap_sum += w - prev;
+                gaps++;
+            }
+            prev = w;
+            first = false;
+        }
+    }
+    uint64_t mine[2] = {gap_sum, gaps};
+    MPI_Allreduce(mine, sums, 2, MPI_UINT64_T, MPI_SUM, comm_);
+    return sums[1] > 0 ? static_cast<double>(sums[0]) / sums[1] : 0.0;
+}
+
+void Graph::printPartitionStats() const {
+    // Cut edges are the ones whose destination lives elsewhere: one message each per push superstep
+    uint64_t cut = 0;
+    #pragma omp parallel for reduction(+:cut) schedule(dynamic, 1024)
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        for (VertexId w : neighbors(i)) {
+            if (w < start_vertex_id_ || w >= end_vertex_id_) cut++;
+        }
+    }
+
+    uint64_t mine[3] = {local_num_vertices_, numLocalEdges(), cut};
+    uint64_t sums[3] = {0, 0, 0};
+    uint64_t maxes[3] = {0, 0, 0};
+    MPI_Allreduce(mine, sums, 3, MPI_UINT64_T, MPI_SUM, comm_);
+    MPI_Allreduce(mine, maxes, 3, MPI_UINT64_T, MPI_MAX, comm_);
+
+    if (rank_ == 0) {
+        auto imbalance = [&](int k) { return sums[k] > 0 ? static_cast<double>(maxes[k]) * size_ / sums[k] : 1.0; };
+        std::cout << "Partition (" << partitionStrategyName(strategy_) << "): vertices max/avg " << imbalance(0)
+                  << ", edges max/avg " << imbalance(1) << ", cut edges "
+                  << (sums[1] > 0 ? 100.0 * sums[2] / sums[1] : 0.0) << "% (max/avg " << imbalance(2) << ")"
+                  << std::endl;
+    }
+}
+
+void Graph::buildInEdges() {
+    struct Arc {
+        VertexId src;
+        VertexId dst;
+    };
+
+    // Route every out-edge to the owner of its destination
+    std::vector<std::vector<Arc>> outboxes(size_);
+    #pragma omp parallel
+    {
+        std::vector<std::vector<Arc>> thread_outboxes(size_);
+
+        #pragma omp for nowait schedule(dynamic, 1024)
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            VertexId src = start_vertex_id_ + i;
+            for (VertexId dst : neighbors(i)) {
+                thread_outboxes[ownerOf(dst)].push_back({src, dst});
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int r = 0; r < size_; ++r) {
+                outboxes[r].insert(outboxes[r].end(), thread_outboxes[r].begin(), thread_outboxes[r].end());
+            }
+        }
+    }
+
+    std::vector<Arc> arcs;
+    exchangeBuffers(comm_, outboxes, arcs);
+    std::vector<std::vector<Arc>>().swap(outboxes);
+
+    InEdgeIndex index;
+
+    // Ghosts: distinct remote sources, grouped by owner so each rank's values arrive contiguously
+    auto ghost_less = [this](VertexId a, VertexId b) {
+        int oa = ownerOf(a), ob = ownerOf(b);
+        return oa != ob ? oa < ob : a < b;
+    };
+    for (const Arc& a : arcs) {
+        if (ownerOf(a.src) != rank_) index.ghost_ids.push_back(a.src);
+    }
+    std::sort(index.ghost_ids.begin(), index.ghost_ids.end(), ghost_less);
+    index.ghost_ids.erase(std::unique(index.ghost_ids.begin(), index.ghost_ids.end()), index.ghost_ids.end());
+
+    if (local_num_vertices_ + index.ghost_ids.size() > UINT32_MAX) {
+        throw std::runtime_error("Too many local + ghost vertices for 32-bit in-edge slots");
+    }
+
+    index.ghost_counts.assign(size_, 0);
+    for (VertexId g : index.ghost_ids) index.ghost_counts[ownerOf(g)]++;
+
+    // Counting sort of arcs by local destination into CSC form
+    const uint64_t num_arcs = arcs.size();
+    index.row_ptr.assign(local_num_vertices_ + 1, 0);
+    for (const Arc& a : arcs) index.row_ptr[a.dst - start_vertex_id_ + 1]++;
+    for (VertexId i = 0; i < local_num_vertices_; ++i) index.row_ptr[i + 1] += index.row_ptr[i];
+
+    index.sources.resize(num_arcs);
+    std::vector<uint64_t> cursor(index.row_ptr.begin(), index.row_ptr.end() - 1);
+    for (const Arc& a : arcs) {
+        uint32_t slot;
+        if (ownerOf(a.src) == rank_) {
+            slot = static_cast<uint32_t>(a.src - start_vertex_id_);
+        } else {
+            auto it = std::lower_bound(index.ghost_ids.begin(), index.ghost_ids.end(), a.src, ghost_less);
+            slot = static_cast<uint32_t>(local_num_vertices_ + (it - index.ghost_ids.begin()));
+        }
+        index.sources[cursor[a.dst - start_vertex_id_]++] = slot;
+    }
+    std::vector<Arc>().swap(arcs);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (VertexId i = 0; i < local_num_vertices_; ++i) {
+        std::sort(index.sources.begin() + index.row_ptr[i], index.sources.begin() + index.row_ptr[i + 1]);
+    }
+
+    // Tell every owner which of its vertices we mirror; their answer is our send list
+    std::vector<std::vector<VertexId>> requests(size_);
+    for (VertexId g : index.ghost_ids) requests[ownerOf(g)].push_back(g);
+    exchangeBuffers(comm_, requests, index.send_local_ids, &index.send_counts);
+    for (VertexId& v : index.send_local_ids) v -= start_vertex_id_;
+
+    in_edges_ = std::move(index);
+
+    uint64_t local_stats[2] = {num_arcs, in_edges_.numGhosts()};
+    uint64_t global_stats[2] = {0, 0};
+    MPI_Allreduce(local_stats, global_stats, 2, MPI_UINT64_T, MPI_SUM, comm_);
+    if (rank_ == 0) {
+        std::cout << "In-edge index built. In-edges: " << global_stats[0]
+                  << ", ghost vertices: " << global_stats[1] << std::endl;
+    }
+}
+
+void Graph::buildEdgeGrid() {
+    releaseEdgeGrid();
+    EdgeGrid grid;
+
+    // Squarest grid: the largest divisor of P not above its square root (a prime P gives 1 x P)
+    grid.rows = 1;
+    for (int r = 1; r * r <= size_; ++r) {
+        if (size_ % r == 0) grid.rows = r;
+    }
+    grid.cols = size_ / grid.rows;
+    grid.row = rank_ / grid.cols;
+    grid.col = rank_ % grid.cols;
+    MPI_Comm_split(comm_, grid.row, grid.col, &grid.row_comm);
+    MPI_Comm_split(comm_, grid.col, grid.row, &grid.col_comm);
+
+    grid.col_counts.resize(grid.rows);
+    grid.col_offsets.assign(grid.rows + 1, 0);
+    for (int k = 0; k < grid.rows; ++k) {
+        grid.col_counts[k] = partition_.rangeSize(k * grid.cols + grid.col);
+        grid.col_offsets[k + 1] = grid.col_offsets[k] + grid.col_counts[k];
+    }
+    if (grid.col_offsets.back() > UINT32_MAX) {
+        throw std::runtime_error("Too many column mirrors for 32-bit edge grid slots");
+    }
+
+    const int first_in_row = grid.row * grid.cols;
+    grid.row_start = partition_.rangeStart(first_in_row);
+    grid.row_size = partition_.rangeEnd(first_in_row + grid.cols - 1) - grid.row_start;
+    grid.row_counts.resize(grid.cols);
+    for (int c = 0; c < grid.cols; ++c) grid.row_counts[c] = partition_.rangeSize(first_in_row + c);
+    grid.row_recv_counts.assign(grid.cols, local_num_vertices_);
+
+    struct Arc {
+        VertexId src;
+        VertexId dst;
+    };
+
+    // Route every out-edge to the rank in its destination's grid row and our grid column
+    std::vector<std::vector<Arc>> outboxes(size_);
+    #pragma omp parallel
+    {
+        std::vector<std::vector<Arc>> thread_outboxes(size_);
+
+        #pragma omp for nowait schedule(dynamic, 1024)
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            VertexId src = start_vertex_id_ + i;
+            for (VertexId dst : neighbors(i)) {
+                int target = ownerOf(dst) / grid.cols * grid.cols + grid.col;
+                thread_outboxes[target].push_back({src, dst});
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int r = 0; r < size_; ++r) {
+                outboxes[r].insert(outboxes[r].end(), thread_outboxes[r].begin(), thread_outboxes[r].end());
+            }
+        }
+    }
+
+    std::vector<Arc> arcs;
+    exchangeBuffers(comm_, outboxes, arcs);
+    std::vector<std::vector<Arc>>().swap(outboxes);
+
+    // Counting sort of arcs by row-partial slot into CSC form
+    grid.dst_ptr.assign(grid.row_size + 1, 0);
+    for (const Arc& a : arcs) grid.dst_ptr[a.dst - grid.row_start + 1]++;
+    for (VertexId d = 0; d < grid.row_size; ++d) grid.dst_ptr[d + 1] += grid.dst_ptr[d];
+
+    grid.sources.resize(arcs.size());
+    std::vector<uint64_t> cursor(grid.dst_ptr.begin(), grid.dst_ptr.end() - 1);
+    for (const Arc& a : arcs) {
+        int owner = ownerOf(a.src);
+        uint32_t slot = static_cast<uint32_t>(grid.col_offsets[owner / grid.cols] + (a.src - partition_.rangeStart(owner)));
+        grid.sources[cursor[a.dst - grid.row_start]++] = slot;
+    }
+    std::vector<Arc>().swap(arcs);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (VertexId d = 0; d < grid.row_size; ++d) {
+        std::sort(grid.sources.begin() + grid.dst_ptr[d], grid.sources.begin() + grid.dst_ptr[d + 1]);
+    }
+
+    // Masters learn whether any rank of their grid row holds in-edges for them
+    std::vector<uint8_t> held(grid.row_size);
+    for (VertexId d = 0; d < grid.row_size; ++d) held[d] = grid.dst_ptr[d + 1] > grid.dst_ptr[d];
+    std::vector<uint8_t> from_row(grid.cols * local_num_vertices_);
+    exchangeKnownCounts(grid.row_comm, held.data(), grid.row_counts, from_row.data(), grid.row_recv_counts);
+    grid.has_in_edges.assign(local_num_vertices_, 0);
+    for (int c = 0; c < grid.cols; ++c) {
+        for (VertexId i = 0; i < local_num_vertices_; ++i) grid.has_in_edges[i] |= from_row[c * local_num_vertices_ + i];
+    }
+
+    edge_grid_ = std::move(grid);
+
+    uint64_t mine[3] = {edge_grid_.numEdges(), edge_grid_.col_offsets.back(), edge_grid_.row_size};
+    uint64_t maxes[3] = {0, 0, 0};
+    uint64_t total_edges = 0;
+    MPI_Allreduce(mine, maxes, 3, MPI_UINT64_T, MPI_MAX, comm_);
+    MPI_Allreduce(&mine[0], &total_edges, 1, MPI_UINT64_T, MPI_SUM, comm_);
+    if (rank_ == 0) {
+        std::cout << "Edge grid built: " << edge_grid_.rows << " x " << edge_grid_.cols << " ranks, edges max/avg "
+                  << (total_edges > 0 ? static_cast<double>(maxes[0]) * size_ / total_edges : 1.0)
+                  << ", up to " << maxes[1] << " column mirrors and " << maxes[2] << " row partials per rank"
+                  << std::endl;
+    }
+}
+
+void Graph::releaseEdgeGrid() {
+    if (edge_grid_.row_comm != MPI_COMM_NULL) MPI_Comm_free(&edge_grid_.row_comm);
+    if (edge_grid_.col_comm != MPI_COMM_NULL) MPI_Comm_free(&edge_grid_.col_comm);
+    edge_grid_ = EdgeGrid();
+}
+
+VertexId Graph::neighborAt(VertexId local_id, uint64_t k) const {
+    uint64_t pos = row_ptr_[local_id] + k;
+    switch (encoding_) {
+        case AdjacencyEncoding::Compact32:
+            return col_ind32_[pos];
+        case AdjacencyEncoding::DeltaVarint: {
+            auto it = neighbors(local_id).begin();
+            for (uint64_t i = 0; i < k; ++i) ++it;
+            return *it;
+        }
+        default:
+            return col_ind_[pos];
+    }
+}
+
+bool Graph::hasEdge(VertexId local_id, VertexId dst) const {
+    uint64_t begin = row_ptr_[local_id];
+    uint64_t end = row_ptr_[local_id + 1];
+    switch (encoding_) {
+        case AdjacencyEncoding::Compact32:
+            return dst <= UINT32_MAX &&
+                   std::binary_search(col_ind32_.data() + begin, col_ind32_.data() + end, static_cast<uint32_t>(dst));
+        case AdjacencyEncoding::DeltaVarint:
+            for (VertexId w : neighbors(local_id)) {
+                if (w >= dst) return w == dst;
+            }
+            return false;
+        default:
+            return std::binary_search(col_ind_.data() + begin, col_ind_.data() + end, dst);
+    }
+}
+
+uint64_t Graph::adjacencyBytes() const {
+    switch (encoding_) {
+        case AdjacencyEncoding::Compact32:
+            return col_ind32_.size() * sizeof(uint32_t);
+        case AdjacencyEncoding::DeltaVarint:
+            return packed_adj_.size() + packed_offsets_.size() * sizeof(uint64_t);
+        default:
+            return col_ind_.size() * sizeof(VertexId);
+    }
+}
+
+void Graph::compressAdjacency(AdjacencyEncoding encoding) {
+    if (encoding == encoding_) return;
+    if (encoding_ != AdjacencyEncoding::Plain) {
+        throw std::runtime_error("Adjacency is already compressed");
+    }
+    if (encoding == AdjacencyEncoding::Compact32 && global_num_vertices_ > UINT32_MAX) {
+        throw std::runtime_error("Compact32 adjacency needs fewer than 2^32 vertices");
+    }
+
+    uint64_t before = adjacencyBytes();
+    const uint64_t num_edges = numLocalEdges();
+
+    if (encoding == AdjacencyEncoding::Compact32) {
+        col_ind32_.resize(num_edges);
+        #pragma omp parallel for
+        for (uint64_t e = 0; e < num_edges; ++e) {
+            col_ind32_[e] = static_cast<uint32_t>(col_ind_[e]);
+        }
+    } else {
+        // Pass 1: encoded size of every row, pass 2: encode into place
+        packed_offsets_.assign(local_num_vertices_ + 1, 0);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            uint64_t bytes = 0;
+            VertexId prev = 0;
+            for (uint64_t e = row_ptr_[i]; e < row_ptr_[i + 1]; ++e) {
+                bytes += varintLength(col_ind_[e] - prev);
+                prev = col_ind_[e];
+            }
+            packed_offsets_[i + 1] = bytes;
+        }
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            packed_offsets_[i + 1] += packed_offsets_[i];
+        }
+
+        packed_adj_.resize(packed_offsets_.back());
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (VertexId i = 0; i < local_num_vertices_; ++i) {
+            uint8_t* out = packed_adj_.data() + packed_offsets_[i];
+            VertexId prev = 0;
+            for (uint64_t e = row_ptr_[i]; e < row_ptr_[i + 1]; ++e) {
+                out += encodeVarint(col_ind_[e] - prev, out);
+                prev = col_ind_[e];
+            }
+        }
+    }
+
+    // Drop the plain ids. A mapped snapshot keeps its pages, but they are never touched again.
+    std::vector<VertexId>().swap(col_ind_storage_);
+    col_ind_ = ArrayView<VertexId>();
+    encoding_ = encoding;
+
+    uint64_t sizes[2] = {before, adjacencyBytes()};
+    uint64_t totals[2] = {0, 0};
+    MPI_Allreduce(sizes, totals, 2, MPI_UINT64_T, MPI_SUM, comm_);
+    if (rank_ == 0) {
+        std::cout << "Adjacency encoded as " << adjacencyEncodingName(encoding_) << ": "
+                  << totals[0] / (1024.0 * 1024.0) << " MiB -> "
+                  << totals[1] / (1024.0 * 1024.0) << " MiB" << std::endl;
+    }
+}
+
+namespace {
+
+void writeFully(int fd, const void* data, uint64_t bytes, uint64_t offset, const std::string& filename) {
+    const char* ptr = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, ptr, bytes, offset);
+        if (written <= 0) {
+            throw std::runtime_error("Failed writing snapshot: " + filename);
+        }
+        ptr += written;
+        bytes -= written;
+        offset += written;
+    }
+}
+
+} // namespace
+
+bool Graph::isSnapshot(const std::string& filename) {
+    std::ifstream infile(filename, std::ios::binary);
+    char magic[sizeof(kSnapshotMagic)] = {};
+    if (!infile.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, kSnapshotMagic, sizeof(magic)) == 0;
+}
+
+void Graph::saveSnapshot(const std::string& filename) const {
+    if (encoding_ != AdjacencyEncoding::Plain) {
+        throw std::runtime_error("Snapshots store plain adjacency; save before compressing");
+    }
+    if (isRelabeled()) {
+        throw std::runtime_error("Snapshots keep the input's vertex ids; save before repartitioning by hash/ldg or reordering");
+    }
+
+    // Every rank needs the full partition table to know where its sections go
+    uint64_t mine[3] = {start_vertex_id_, end_vertex_id_, numLocalEdges()};
+    std::vector<uint64_t> all(3 * size_);
+    MPI_Allgather(mine, 3, MPI_UINT64_T, all.data(), 3, MPI_UINT64_T, comm_);
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.num_partitions = size_;
+    header.num_vertices = global_num_vertices_;
+    header.partition_strategy = static_cast<uint64_t>(strategy_);
+
+    std::vector<SnapshotPartition> table(size_);
+    uint64_t offset = sizeof(SnapshotHeader) + size_ * sizeof(SnapshotPartition);
+    for (int r = 0; r < size_; ++r) {
+        SnapshotPartition& part = table[r];
+        part.start_vertex = all[3 * r];
+        part.end_vertex = all[3 * r + 1];
+        part.num_edges = all[3 * r + 2];
+        header.num_edges += part.num_edges;
+
+        uint64_t nv = part.end_vertex - part.start_vertex;
+        part.row_ptr_offset = alignSnapshotOffset(offset);
+        part.col_ind_offset = alignSnapshotOffset(part.row_ptr_offset + (nv + 1) * sizeof(uint64_t));
+        part.weights_offset = alignSnapshotOffset(part.col_ind_offset + part.num_edges * sizeof(VertexId));
+        offset = part.weights_offset + part.num_edges * sizeof(EdgeWeight);
+    }
+
+    // Rank 0 creates the file and writes the metadata; everyone then fills in their slice
+    if (rank_ == 0) {
+        int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Could not create snapshot: " + filename);
+        if (ftruncate(fd, offset) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not size snapshot: " + filename);
+        }
+        writeFully(fd, &header, sizeof(header), 0, filename);
+        writeFully(fd, table.data(), table.size() * sizeof(SnapshotPartition), sizeof(header), filename);
+        ::close(fd);
+    }
+    MPI_Barrier(comm_);
+
+    int fd = ::open(filename.c_str(), O_WRONLY);
+    if (fd < 0) throw std::runtime_error("Could not open snapshot: " + filename);
+    const SnapshotPartition& part = table[rank_];
+    writeFully(fd, row_ptr_.data(), row_ptr_.size() * sizeof(uint64_t), part.row_ptr_offset, filename);
+    writeFully(fd, col_ind_.data(), col_ind_.size() * sizeof(VertexId), part.col_ind_offset, filename);
+    writeFully(fd, weights_.data(), weights_.size() * sizeof(EdgeWeight), part.weights_offset, filename);
+    ::close(fd);
+    MPI_Barrier(comm_);
+
+    if (rank_ == 0) {
+        std::cout << "Snapshot written to " << filename << " (" << size_ << " partitions, "
+                  << header.num_edges << " edges, " << offset << " bytes)" << std::endl;
+    }
+}
+
+void Graph::loadSnapshot(const std::string& filename) {
+    SnapshotHeader header;
+    SnapshotPartition part;
+    std::vector<SnapshotPartition> table;
+
+    // Header and partition table are tiny; read them with plain I/O
+    {
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile.is_open()) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+        if (!infile.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            throw std::runtime_error("Truncated snapshot: " + filename);
+        }
+        if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+            throw std::runtime_error("Not a graph snapshot: " + filename);
+        }
+        if (header.version != kSnapshotVersion) {
+            throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version) + ": " + filename);
+        }
+        if (header.num_partitions != static_cast<uint32_t>(size_)) {
+            throw std::runtime_error("Snapshot has " + std::to_string(header.num_partitions) +
+                                     " partitions but running on " + std::to_string(size_) +
+                                     " ranks; re-convert with a matching rank count: " + filename);
+        }
+        // The whole table is needed for owner lookups
+        table.resize(size_);
+        if (!infile.read(reinterpret_cast<char*>(table.data()), size_ * sizeof(SnapshotPartition))) {
+            throw std::runtime_error("Truncated snapshot: " + filename);
+        }
+        part = table[rank_];
+    }
+
+    global_num_vertices_ = header.num_vertices;
+    strategy_ = static_cast<PartitionStrategy>(header.partition_strategy);
+    original_ids_.clear();
+    if (strategy_ == PartitionStrategy::Range) {
+        partition_ = Partition::uniform(global_num_vertices_, size_);
+    } else {
+        std::vector<VertexId> starts(size_ + 1, global_num_vertices_);
+        for (int r = 0; r < size_; ++r) starts[r] = table[r].start_vertex;
+        partition_ = Partition::fromBoundaries(std::move(starts));
+    }
+    start_vertex_id_ = part.start_vertex;
+    end_vertex_id_ = part.end_vertex;
+    local_num_vertices_ = end_vertex_id_ - start_vertex_id_;
+    if (partition_.rangeStart(rank_) != start_vertex_id_ || partition_.rangeEnd(rank_) != end_vertex_id_) {
+        throw std::runtime_error("Corrupt snapshot partition table: " + filename);
+    }
+
+    row_ptr_storage_.clear();
+    col_ind_storage_.clear();
+    weights_storage_.clear();
+    in_edges_ = InEdgeIndex();
+    releaseEdgeGrid();
+
+    // Map only this rank's slice; sections are laid out back to back
+    uint64_t slice_end = part.weights_offset + part.num_edges * sizeof(EdgeWeight);
+    snapshot_.open(filename, part.row_ptr_offset, slice_end - part.row_ptr_offset);
+    const uint8_t* base = snapshot_.data();
+    row_ptr_ = ArrayView<uint64_t>(reinterpret_cast<const uint64_t*>(base),
+                                   local_num_vertices_ + 1);
+    col_ind_ = ArrayView<VertexId>(reinterpret_cast<const VertexId*>(base + (part.col_ind_offset - part.row_ptr_offset)),
+                                   part.num_edges);
+    weights_ = ArrayView<EdgeWeight>(reinterpret_cast<const EdgeWeight*>(base + (part.weights_offset - part.row_ptr_offset)),
+                                     part.num_edges);
+
+    if (row_ptr_.back() != part.num_edges) {
+        throw std::runtime_error("Corrupt snapshot partition " + std::to_string(rank_) + ": " + filename);
+    }
+    computeInverseDegrees();
+
+    if (rank_ == 0) {
+        std::cout << "Graph mapped from snapshot. Global Vertices: " << global_num_vertices_
+                  << ". Local edges on Rank 0: " << part.num_edges << std::endl;
     }
 }
 
@@ -0,0 +1,95 @@
+#include "dgraph/MappedFile.hpp"
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dgraph {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(base_, other.base_);
+        std::swap(mapped_len_, other.mapped_len_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+    return *this;
+}
+
+uint64_t MappedFile::fileSize(const std::string& filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) {
+        throw std::runtime_error("Could not stat file: " + filename);
+    }
+    return static_cast<uint64_t>(st.st_size);
+}
+
+void MappedFile::open(const std::string& filename, uint64_t offset, uint64_t length) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat file: " + filename);
+    }
+    uint64_t file_size = static_cast<uint64_t>(st.st_size);
+    if (length == 0) length = (offset < file_size) ? file_size - offset : 0;
+    if (offset + length > file_size) {
+        ::close(fd);
+        throw std::runtime_error("Mapping past end of file: " + filename);
+    }
+    if (length == 0) {
+        // mmap rejects zero-length mappings; an empty region is still "open"
+        ::close(fd);
+        static const uint8_t empty = 0;
+        base_ = const_cast<uint8_t*>(&empty);
+        mapped_len_ = 0;
+        data_ = &empty;
+        size_ = 0;
+        return;
+    }
+
+    // mmap offsets must be page aligned
+    uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t aligned = offset - (offset % page);
+    uint64_t slack = offset - aligned;
+
+    void* addr = mmap(nullptr, length + slack, PROT_READ, MAP_SHARED, fd, aligned);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("mmap failed for file: " + filename);
+    }
+
+    base_ = addr;
+    mapped_len_ = length + slack;
+    data_ = static_cast<const uint8_t*>(addr) + slack;
+    size_ = length;
+}
+
+void MappedFile::close() {
+    if (base_ && mapped_len_ > 0) {
+        munmap(base_, mapped_len_);
+    }
+    base_ = nullptr;
+    mapped_len_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace dgraph
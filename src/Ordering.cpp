@@ -0,0 +1,152 @@
+#include "dgraph/Ordering.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <queue>
+
+namespace dgraph {
+
+namespace {
+
+// Positions from a sequence listing the vertices in their new order
+std::vector<VertexId> positionsOf(const std::vector<VertexId>& sequence) {
+    std::vector<VertexId> position(sequence.size());
+    for (VertexId k = 0; k < sequence.size(); ++k) position[sequence[k]] = k;
+    return position;
+}
+
+std::vector<VertexId> byKey(const std::vector<VertexId>& keys) {
+    std::vector<VertexId> sequence(keys.size());
+    for (VertexId v = 0; v < keys.size(); ++v) sequence[v] = v;
+    std::sort(sequence.begin(), sequence.end(), [&](VertexId a, VertexId b) { return keys[a] < keys[b]; });
+    return sequence;
+}
+
+std::vector<VertexId> degreeOrder(const LocalAdjacency& adj, const std::vector<VertexId>& keys) {
+    std::vector<VertexId> sequence = byKey(keys);
+    std::stable_sort(sequence.begin(), sequence.end(), [&](VertexId a, VertexId b) {
+        return adj.out_degree[a] > adj.out_degree[b];
+    });
+    return sequence;
+}
+
+std::vector<VertexId> reverseCuthillMcKee(const LocalAdjacency& adj, const std::vector<VertexId>& keys) {
+    const VertexId n = adj.numVertices();
+    auto lighter = [&](VertexId a, VertexId b) {
+        return adj.degree(a) != adj.degree(b) ? adj.degree(a) < adj.degree(b) : keys[a] < keys[b];
+    };
+
+    // Every component starts from its lowest-degree vertex
+    std::vector<VertexId> seeds = byKey(keys);
+    std::stable_sort(seeds.begin(), seeds.end(), lighter);
+
+    std::vector<VertexId> sequence;
+    sequence.reserve(n);
+    std::vector<uint8_t> visited(n, 0);
+    std::vector<VertexId> level;
+    for (VertexId seed : seeds) {
+        if (visited[seed]) continue;
+        visited[seed] = 1;
+        size_t head = sequence.size();
+        sequence.push_back(seed);
+        while (head < sequence.size()) {
+            VertexId u = sequence[head++];
+            level.clear();
+            for (uint64_t e = adj.row_ptr[u]; e < adj.row_ptr[u + 1]; ++e) {
+                VertexId w = adj.neighbors[e];
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    level.push_back(w);
+                }
+            }
+            std::sort(level.begin(), level.end(), lighter);
+            sequence.insert(sequence.end(), level.begin(), level.end());
+        }
+    }
+    std::reverse(sequence.begin(), sequence.end());
+    return sequence;
+}
+
+// Gorder places next the vertex with the most neighbors and siblings (shared neighbors)
+// among the last kWindow placed ones. Scores are kept incrementally: placing u credits
+// u's neighbors and their neighbors, and u leaving the window takes the credit back.
+// Siblings are not expanded through hubs, which would make the cost quadratic.
+std::vector<VertexId> gorderLike(const LocalAdjacency& adj, const std::vector<VertexId>& keys) {
+    const size_t kWindow = 5;
+    const VertexId n = adj.numVertices();
+    const VertexId hub_degree = std::max<VertexId>(16, static_cast<VertexId>(std::sqrt(static_cast<double>(n))));
+
+    // Fallback when nothing in the window scores: the next unplaced vertex by degree
+    std::vector<VertexId> seeds = byKey(keys);
+    std::stable_sort(seeds.begin(), seeds.end(), [&](VertexId a, VertexId b) { return adj.degree(a) > adj.degree(b); });
+    std::vector<VertexId> seed_rank = positionsOf(seeds);
+    size_t next_seed = 0;
+
+    std::vector<int64_t> score(n, 0);
+    std::vector<uint8_t> placed(n, 0);
+    using Entry = std::pair<int64_t, VertexId>;
+    auto worse = [&](const Entry& a, const Entry& b) {
+        return a.first != b.first ? a.first < b.first : seed_rank[a.second] > seed_rank[b.second];
+    };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(worse)> heap(worse);
+
+    auto bump = [&](VertexId v, int64_t delta) {
+        if (placed[v]) return;
+        score[v] += delta;
+        if (score[v] > 0) heap.push({score[v], v});
+    };
+    auto credit = [&](VertexId u, int64_t delta) {
+        for (uint64_t e = adj.row_ptr[u]; e < adj.row_ptr[u + 1]; ++e) {
+            VertexId x = adj.neighbors[e];
+            bump(x, delta);
+            if (adj.degree(x) > hub_degree) continue;
+            for (uint64_t f = adj.row_ptr[x]; f < adj.row_ptr[x + 1]; ++f) {
+                if (adj.neighbors[f] != u) bump(adj.neighbors[f], delta);
+            }
+        }
+    };
+
+    std::vector<VertexId> sequence;
+    sequence.reserve(n);
+    std::deque<VertexId> window;
+    while (sequence.size() < n) {
+        VertexId v = n;
+        while (!heap.empty()) {
+            Entry top = heap.top();
+            heap.pop();
+            // Entries go stale when a vertex is placed or its score changes
+            if (!placed[top.second] && score[top.second] == top.first) {
+                v = top.second;
+                break;
+            }
+        }
+        if (v == n) {
+            while (placed[seeds[next_seed]]) ++next_seed;
+            v = seeds[next_seed];
+        }
+
+        placed[v] = 1;
+        sequence.push_back(v);
+        window.push_back(v);
+        credit(v, 1);
+        if (window.size() > kWindow) {
+            credit(window.front(), -1);
+            window.pop_front();
+        }
+    }
+    return sequence;
+}
+
+} // namespace
+
+std::vector<VertexId> computeOrdering(VertexOrdering ordering, const LocalAdjacency& adj,
+                                      const std::vector<VertexId>& keys) {
+    switch (ordering) {
+        case VertexOrdering::Degree: return positionsOf(degreeOrder(adj, keys));
+        case VertexOrdering::RCM: return positionsOf(reverseCuthillMcKee(adj, keys));
+        case VertexOrdering::Gorder: return positionsOf(gorderLike(adj, keys));
+        default: return positionsOf(byKey(keys));
+    }
+}
+
+} // namespace dgraph
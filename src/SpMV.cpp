@@ -0,0 +1,245 @@
+#include "dgraph/SpMV.hpp"
+#include <algorithm>
+#include <chrono>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DGRAPH_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace dgraph {
+
+namespace {
+
+// Float values are summed in double as well: a hub's row can hold millions of terms, and a
+// float accumulator loses percents on those. Only the gathered vector shrinks.
+template <typename T>
+inline double rowSum(const uint32_t* sources, const T* values, uint64_t begin, uint64_t end) {
+    double sum = 0;
+    for (uint64_t e = begin; e < end; ++e) sum += values[sources[e]];
+    return sum;
+}
+
+template <typename T>
+void gatherSumScalar(const uint64_t* row_ptr, const uint32_t* sources, const T* values, T* sums,
+                     VertexId row_begin, VertexId row_end) {
+    for (VertexId i = row_begin; i < row_end; ++i) {
+        sums[i] = static_cast<T>(rowSum(sources, values, row_ptr[i], row_ptr[i + 1]));
+    }
+}
+
+#ifdef DGRAPH_X86_KERNELS
+
+// Compiled for the instruction set named in the attribute only; callers check the CPU first.
+// Gathers and conversions use their masked forms with an explicit zero source, and the 512-bit
+// accumulators are folded through memory: GCC's unmasked 512-bit forms read an undefined
+// register and trip -Wmaybe-uninitialized. Rows shorter than one vector take the scalar
+// loop: a gather plus a horizontal sum costs more than a handful of loads.
+
+__attribute__((target("avx2"))) inline double horizontalSum(__m256d v) {
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2"))) void gatherSumAVX2(const uint64_t* row_ptr, const uint32_t* sources,
+                                                   const double* values, double* sums,
+                                                   VertexId row_begin, VertexId row_end) {
+    for (VertexId i = row_begin; i < row_end; ++i) {
+        uint64_t e = row_ptr[i];
+        const uint64_t end = row_ptr[i + 1];
+        if (end - e < 4) {
+            sums[i] = rowSum(sources, values, e, end);
+            continue;
+        }
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d acc = zero;
+        for (; e + 4 <= end; e += 4) {
+            __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources + e));
+            acc = _mm256_add_pd(acc, _mm256_mask_i32gather_pd(zero, values, idx, all, 8));
+        }
+        double sum = horizontalSum(acc);
+        for (; e < end; ++e) sum += values[sources[e]];
+        sums[i] = sum;
+    }
+}
+
+__attribute__((target("avx2"))) void gatherSumAVX2(const uint64_t* row_ptr, const uint32_t* sources,
+                                                   const float* values, float* sums,
+                                                   VertexId row_begin, VertexId row_end) {
+    for (VertexId i = row_begin; i < row_end; ++i) {
+        uint64_t e = row_ptr[i];
+        const uint64_t end = row_ptr[i + 1];
+        if (end - e < 8) {
+            sums[i] = static_cast<float>(rowSum(sources, values, e, end));
+            continue;
+        }
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+        for (; e + 8 <= end; e += 8) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources + e));
+            __m256 gathered = _mm256_mask_i32gather_ps(zero, values, idx, all, 4);
+            low = _mm256_add_pd(low, _mm256_cvtps_pd(_mm256_castps256_ps128(gathered)));
+            high = _mm256_add_pd(high, _mm256_cvtps_pd(_mm256_extractf128_ps(gathered, 1)));
+        }
+        double sum = horizontalSum(_mm256_add_pd(low, high));
+        for (; e < end; ++e) sum += values[sources[e]];
+        sums[i] = static_cast<float>(sum);
+    }
+}
+
+// AVX-512 handles the tail of a long row with a masked gather instead of a scalar loop
+
+__attribute__((target("avx512f"))) void gatherSumAVX512(const uint64_t* row_ptr, const uint32_t* sources,
+                                                       const double* values, double* sums,
+                                                       VertexId row_begin, VertexId row_end) {
+    for (VertexId i = row_begin; i < row_end; ++i) {
+        uint64_t e = row_ptr[i];
+        const uint64_t end = row_ptr[i + 1];
+        if (end - e < 8) {
+            sums[i] = rowSum(sources, values, e, end);
+            continue;
+        }
+        __m512d acc = _mm512_setzero_pd();
+        for (; e + 8 <= end; e += 8) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources + e));
+            acc = _mm512_add_pd(acc, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, idx, values, 8));
+        }
+        if (e < end) {
+            alignas(32) uint32_t tail[8] = {};
+            std::copy(sources + e, sources + end, tail);
+            __mmask8 mask = static_cast<__mmask8>((1u << (end - e)) - 1);
+            __m256i idx = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+            acc = _mm512_add_pd(acc, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, idx, values, 8));
+        }
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, acc);
+        sums[i] = horizontalSum(_mm256_add_pd(_mm256_load_pd(lanes), _mm256_load_pd(lanes + 4)));
+    }
+}
+
+// Floats are gathered eight at a time so each batch widens into one 512-bit double add
+__attribute__((target("avx512f"))) void gatherSumAVX512(const uint64_t* row_ptr, const uint32_t* sources,
+                                                       const float* values, float* sums,
+                                                       VertexId row_begin, VertexId row_end) {
+    for (VertexId i = row_begin; i < row_end; ++i) {
+        uint64_t e = row_ptr[i];
+        const uint64_t end = row_ptr[i + 1];
+        if (end - e < 8) {
+            sums[i] = static_cast<float>(rowSum(sources, values, e, end));
+            continue;
+        }
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        __m512d acc = _mm512_setzero_pd();
+        for (; e + 8 <= end; e += 8) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources + e));
+            __m256 gathered = _mm256_mask_i32gather_ps(zero, values, idx, all, 4);
+            acc = _mm512_add_pd(acc, _mm512_mask_cvtps_pd(_mm512_setzero_pd(), 0xFF, gathered));
+        }
+        if (e < end) {
+            alignas(32) uint32_t tail[8] = {};
+            std::copy(sources + e, sources + end, tail);
+            __m256i positions = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            __m256 mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(end - e)), positions));
+            __m256i idx = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+            __m256 gathered = _mm256_mask_i32gather_ps(zero, values, idx, mask, 4);
+            acc = _mm512_add_pd(acc, _mm512_mask_cvtps_pd(_mm512_setzero_pd(), 0xFF, gathered));
+        }
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, acc);
+        sums[i] = static_cast<float>(horizontalSum(_mm256_add_pd(_mm256_load_pd(lanes), _mm256_load_pd(lanes + 4))));
+    }
+}
+
+#endif
+
+template <typename T>
+void dispatch(SpmvKernel kernel, const uint64_t* row_ptr, const uint32_t* sources, const T* values, T* sums,
+              VertexId row_begin, VertexId row_end) {
+#ifdef DGRAPH_X86_KERNELS
+    switch (kernel) {
+        case SpmvKernel::AVX2: return gatherSumAVX2(row_ptr, sources, values, sums, row_begin, row_end);
+        case SpmvKernel::AVX512: return gatherSumAVX512(row_ptr, sources, values, sums, row_begin, row_end);
+        default: break;
+    }
+#else
+    (void)kernel;
+#endif
+    gatherSumScalar(row_ptr, sources, values, sums, row_begin, row_end);
+}
+
+// Times every supported kernel single-threaded on evenly spaced blocks of rows covering
+// about kSampleEdges edges, best of three runs each. Ties go to the narrower kernel.
+template <typename T>
+SpmvKernel measureFastest(const uint64_t* row_ptr, const uint32_t* sources, const T* values, T* sums,
+                          VertexId num_rows) {
+    const uint64_t kSampleEdges = uint64_t(1) << 20;
+    const VertexId kBlock = 1024;
+    const uint64_t num_edges = row_ptr[num_rows];
+    if (num_edges == 0) return SpmvKernel::Scalar;
+    const VertexId stride = kBlock * std::max<uint64_t>(1, num_edges / kSampleEdges);
+
+    SpmvKernel best = SpmvKernel::Scalar;
+    double best_seconds = 0.0;
+    for (SpmvKernel kernel : {SpmvKernel::Scalar, SpmvKernel::AVX2, SpmvKernel::AVX512}) {
+        if (!spmvKernelSupported(kernel)) continue;
+        double seconds = 0.0;
+        for (int run = 0; run < 3; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (VertexId begin = 0; begin < num_rows; begin += stride) {
+                dispatch(kernel, row_ptr, sources, values, sums, begin, std::min(begin + kBlock, num_rows));
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || elapsed < seconds) seconds = elapsed;
+        }
+        if (kernel == SpmvKernel::Scalar || seconds < best_seconds) {
+            best = kernel;
+            best_seconds = seconds;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+bool spmvKernelSupported(SpmvKernel kernel) {
+    switch (kernel) {
+#ifdef DGRAPH_X86_KERNELS
+        case SpmvKernel::AVX2: return __builtin_cpu_supports("avx2");
+        case SpmvKernel::AVX512: return __builtin_cpu_supports("avx512f");
+#else
+        case SpmvKernel::AVX2:
+        case SpmvKernel::AVX512: return false;
+#endif
+        default: return true;
+    }
+}
+
+SpmvKernel resolveSpmvKernel(SpmvKernel kernel) {
+    if (kernel == SpmvKernel::Auto) return kernel;
+    return spmvKernelSupported(kernel) ? kernel : SpmvKernel::Scalar;
+}
+
+SpmvKernel fastestSpmvKernel(const uint64_t* row_ptr, const uint32_t* sources, const double* values,
+                             double* sums, VertexId num_rows) {
+    return measureFastest(row_ptr, sources, values, sums, num_rows);
+}
+
+SpmvKernel fastestSpmvKernel(const uint64_t* row_ptr, const uint32_t* sources, const float* values,
+                             float* sums, VertexId num_rows) {
+    return measureFastest(row_ptr, sources, values, sums, num_rows);
+}
+
+void gatherSum(SpmvKernel kernel, const uint64_t* row_ptr, const uint32_t* sources, const double* values,
+               double* sums, VertexId row_begin, VertexId row_end) {
+    dispatch(kernel, row_ptr, sources, values, sums, row_begin, row_end);
+}
+
+void gatherSum(SpmvKernel kernel, const uint64_t* row_ptr, const uint32_t* sources, const float* values,
+               float* sums, VertexId row_begin, VertexId row_end) {
+    dispatch(kernel, row_ptr, sources, values, sums, row_begin, row_end);
+}
+
+} // namespace dgraph
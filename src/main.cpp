@@ -1,14 +1,20 @@
 #include "dgraph/MPI_Wrapper.hpp"
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "dgraph/Graph.hpp"
+#include "dgraph/Exchange.hpp"
 #include "dgraph/IAlgorithm.hpp"
 #include "dgraph/plugins/BuiltinAlgorithms.hpp"
+#include "dgraph/plugins/BenchmarkAlgorithms.hpp"
 #include "dgraph/plugins/UserAlgorithms.hpp"
 
-int main(int argc, char** argv) {
+// Everything one rank does, from MPI init to finalize
+static int runRank(int argc, char** argv) {
     // 1. Initialize MPI
     int provided;
     MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
@@ -17,9 +23,33 @@ int main(int argc, char** argv) {
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    if (argc < 2) {
+    // Split "--key=value" load options from the positional arguments.
+    // Options the loader doesn't know are handed to the algorithm.
+    const std::set<std::string> load_options = {"adjacency", "exchange-budget", "partition", "reorder"};
+    std::vector<std::string> positional;
+    std::vector<std::string> algo_options;
+    std::map<std::string, std::string> options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0) {
+            size_t eq = arg.find('=');
+            std::string key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+            if (load_options.count(key)) {
+                options[key] = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+            } else {
+                algo_options.push_back(arg);
+            }
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty()) {
         if (rank == 0) {
             std::cerr << "Usage: " << argv[0] << " <graph_file> [algorithm] [params...]" << std::endl;
+            std::cerr << "       " << argv[0] << " <graph_file> convert <snapshot_file>" << std::endl;
+            std::cerr << "Options: --adjacency=plain|u32|varint --exchange-budget=<MiB> --partition=range|edges|hash|ldg" << std::endl;
+            std::cerr << "         --reorder=original|degree|rcm|gorder" << std::endl;
             std::cerr << "Available Algorithms: ";
             auto& registry = dgraph::AlgorithmRegistry::instance().getAll();
             for (const auto& pair : registry) {
@@ -31,20 +61,60 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    std::string filename = argv[1];
-    std::string algo_name = (argc >= 3) ? argv[2] : "default";
+    std::string filename = positional[0];
+    std::string algo_name = (positional.size() >= 2) ? positional[1] : "default";
     
     std::vector<std::string> algo_args;
-    for(int i=3; i<argc; ++i) algo_args.push_back(argv[i]);
+    for(size_t i=2; i<positional.size(); ++i) algo_args.push_back(positional[i]);
+    algo_args.insert(algo_args.end(), algo_options.begin(), algo_options.end());
 
     try {
+        // Bytes staged per all-to-all round; bigger exchanges are split into several rounds
+        if (options.count("exchange-budget")) {
+            double mib = std::stod(options["exchange-budget"]);
+            if (mib <= 0) throw std::runtime_error("--exchange-budget must be positive");
+            dgraph::setExchangeBudget(static_cast<size_t>(mib * 1024 * 1024));
+        }
+
         // 2. Load Graph
         dgraph::Graph graph(MPI_COMM_WORLD);
         if (rank == 0) std::cout << "Loading graph from " << filename << "..." << std::endl;
         graph.loadFromFile(filename);
 
+        if (options.count("partition")) {
+            dgraph::PartitionStrategy strategy;
+            if (!dgraph::parsePartitionStrategy(options["partition"], strategy)) {
+                throw std::runtime_error("Unknown partition strategy: " + options["partition"]);
+            }
+            graph.repartition(strategy);
+        }
+        graph.printPartitionStats();
+
+        if (options.count("reorder")) {
+            dgraph::VertexOrdering ordering;
+            if (!dgraph::parseVertexOrdering(options["reorder"], ordering)) {
+                throw std::runtime_error("Unknown vertex ordering: " + options["reorder"]);
+            }
+            graph.reorder(ordering);
+        }
+
+        if (options.count("adjacency")) {
+            dgraph::AdjacencyEncoding encoding;
+            if (!dgraph::parseAdjacencyEncoding(options["adjacency"], encoding)) {
+                throw std::runtime_error("Unknown adjacency encoding: " + options["adjacency"]);
+            }
+            graph.compressAdjacency(encoding);
+        }
+
         // 3. Run Algorithm
-        if (algo_name == "default") {
+        if (algo_name == "convert") {
+            // Converter mode: write a binary CSR snapshot for fast warm starts
+            if (algo_args.empty()) {
+                if (rank == 0) std::cerr << "convert requires an output snapshot path" << std::endl;
+            } else {
+                graph.saveSnapshot(algo_args[0]);
+            }
+        } else if (algo_name == "default") {
             // Backward compatibility: Run PR and LPA
              if (rank == 0) std::cout << "Running default suite (PR + LPA)..." << std::endl;
              
@@ -70,3 +140,12 @@ int main(int argc, char** argv) {
     MPI_Finalize();
     return 0;
 }
+
+int main(int argc, char** argv) {
+#ifdef USE_MPI
+    return runRank(argc, argv);
+#else
+    // Without MPI, ranks are simulated as threads (DGRAPH_SIM_RANKS, see mock_mpi.hpp)
+    return mock_mpi::launch(argc, argv, runRank);
+#endif
+}